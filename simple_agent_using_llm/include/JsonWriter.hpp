@@ -0,0 +1,32 @@
+#ifndef JSON_WRITER_HPP
+#define JSON_WRITER_HPP
+
+#include <string>
+#include <string_view>
+
+// 호출자가 준 버퍼 끝에 JSON을 바로 써 나가는 스트리밍 작성기
+// 버퍼를 재사용하면 호출마다 할당이 생기지 않습니다. 쉼표는 작성기가 넣고,
+// 문자열은 따옴표, 역슬래시, 제어 문자(0x00-0x1F)를 이스케이프합니다 (UTF-8은 그대로 통과).
+// 이스케이프할 문자가 있는지는 16바이트씩 SIMD로 검사하고 문제없는 구간은 한 번에 복사합니다.
+class JsonWriter {
+private:
+    std::string& buffer;
+    bool needsComma = false;
+    
+    void separate();
+    
+public:
+    explicit JsonWriter(std::string& out) : buffer(out) {}
+    
+    JsonWriter& beginObject();
+    JsonWriter& endObject();
+    JsonWriter& key(std::string_view name);
+    
+    JsonWriter& value(std::string_view text);
+    JsonWriter& value(const char* text) { return value(std::string_view(text)); }
+    
+    // text를 이스케이프해 out 끝에 추가 (따옴표는 붙이지 않음)
+    static void appendEscaped(std::string& out, std::string_view text);
+};
+
+#endif // JSON_WRITER_HPP
@@ -12,7 +12,7 @@ public:
     virtual ~LLMAgent() = default;
     virtual std::string generateResponse(const std::string& prompt) = 0;
     virtual std::vector<float> generateEmbedding(const std::string& text) = 0;
-    virtual std::string summarizeConversation(const std::vector<Message>& messages) = 0;
+    virtual std::string summarizeConversation(const std::vector<MessageView>& messages) = 0;
 };
 
 // ChatGPT 구현
@@ -20,7 +20,7 @@ class ChatGPTAgent : public LLMAgent {
 public:
     std::string generateResponse(const std::string& prompt) override;
     std::vector<float> generateEmbedding(const std::string& text) override;
-    std::string summarizeConversation(const std::vector<Message>& messages) override;
+    std::string summarizeConversation(const std::vector<MessageView>& messages) override;
 };
 
 // Claude 구현
@@ -28,7 +28,7 @@ class ClaudeAgent : public LLMAgent {
 public:
     std::string generateResponse(const std::string& prompt) override;
     std::vector<float> generateEmbedding(const std::string& text) override;
-    std::string summarizeConversation(const std::vector<Message>& messages) override;
+    std::string summarizeConversation(const std::vector<MessageView>& messages) override;
 };
 
 #endif // LLM_AGENT_HPP
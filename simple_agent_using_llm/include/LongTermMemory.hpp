@@ -18,7 +18,7 @@ private:
 public:
     LongTermMemory(std::shared_ptr<VectorDB> db, std::shared_ptr<LLMAgent> agent);
     
-    void storeConversation(const std::string& sessionId, const std::vector<Message>& conversation);
+    void storeConversation(const std::string& sessionId, const std::vector<MessageView>& conversation);
     std::vector<std::string> retrieveSimilarConversations(const std::string& query, int topK = 5);
 };
 
@@ -3,9 +3,12 @@
 
 #include "ShortTermMemory.hpp"
 #include "LongTermMemory.hpp"
+#include "WorkerPool.hpp"
 #include <memory>
 #include <string>
 #include <vector>
+#include <future>
+#include <chrono>
 
 class MemoryManager {
 private:
@@ -13,8 +16,21 @@ private:
     std::shared_ptr<LongTermMemory> longTermMemory;
     std::string currentSessionId;
     
+    // 제한 시간을 넘겨 아직 끝나지 않은 장기 기억 검색 (끝나기 전에는 새 검색을 시작하지 않음)
+    std::future<std::vector<std::string>> lateRetrieval;
+    size_t retrievalTimeouts = 0;
+    size_t skippedRetrievals = 0;
+    
 public:
+    struct TurnResult {
+        std::string prompt;     // 생성에 사용한 최종 프롬프트
+        std::string response;
+    };
+    
     MemoryManager(std::shared_ptr<LLMAgent> agent, std::shared_ptr<VectorDB> db);
+    // 여러 세션이 장기 기억 하나를 공유할 때 (SessionManager)
+    MemoryManager(std::shared_ptr<ShortTermMemory> shortTerm, std::shared_ptr<LongTermMemory> longTerm,
+                  const std::string& sessionId);
     
     std::string generateSessionId();
     void startNewSession();
@@ -24,8 +40,18 @@ public:
     std::string preparePromptForNewQuery(const std::string& newQuery);
     std::vector<std::string> retrieveRelevantConversations(const std::string& query, int topK = 3);
     
+    // 한 턴 처리 (UserAgent와 SessionManager 공용): 사용자 메시지 저장, 프롬프트 준비, 응답 생성과 저장
+    // 장기 기억 검색은 retrievalPool에서 프롬프트 준비와 동시에 진행하고, retrievalTimeout을 넘기면
+    // 검색 결과 없이 생성합니다. 이전 턴의 검색이 아직 끝나지 않았으면 이번 턴은 검색을 생략합니다.
+    // 같은 MemoryManager에 대해 동시에 호출하면 안 됨
+    TurnResult processTurn(LLMAgent& agent, const std::string& query,
+                           WorkerPool& retrievalPool, std::chrono::milliseconds retrievalTimeout);
+    size_t getRetrievalTimeoutCount() const { return retrievalTimeouts; }   // 제한 시간을 넘긴 검색 수
+    size_t getSkippedRetrievalCount() const { return skippedRetrievals; }   // 이전 검색이 끝나지 않아 생략한 수
+    
     std::shared_ptr<ShortTermMemory> getShortTermMemory();
     std::shared_ptr<LongTermMemory> getLongTermMemory();
+    const std::string& getSessionId() const;
 };
 
 #endif // MEMORY_MANAGER_HPP
@@ -2,8 +2,10 @@
 #define MESSAGE_HPP
 
 #include <string>
+#include <string_view>
 #include <chrono>
-#include <sstream>
+
+class JsonWriter;
 
 struct Message {
     enum class Role { USER, ASSISTANT };
@@ -12,10 +14,23 @@ struct Message {
     std::string content;
     std::chrono::system_clock::time_point timestamp;
     
-    Message(Role r, const std::string& c);
+    Message(Role r, std::string c);
+    
+    std::string getRoleString() const;
+    std::string toJSON() const;
+};
+
+// 메시지 아레나(MessageArena)에 저장된 메시지를 복사 없이 가리키는 뷰
+// 내용은 아레나가 살아 있는 동안만 유효합니다.
+struct MessageView {
+    Message::Role role;
+    std::string_view content;
+    std::chrono::system_clock::time_point timestamp;
     
     std::string getRoleString() const;
     std::string toJSON() const;
+    void writeJSON(JsonWriter& writer) const;
+    Message toMessage() const;
 };
 
 #endif // MESSAGE_HPP
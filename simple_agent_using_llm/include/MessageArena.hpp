@@ -0,0 +1,42 @@
+#ifndef MESSAGE_ARENA_HPP
+#define MESSAGE_ARENA_HPP
+
+#include "Message.hpp"
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+// 추가 전용 메시지 저장소
+// 메시지 내용을 큰 블록에 이어 붙여 저장하므로 메시지마다 힙 할당이 없고, 블록은 옮겨지지 않아
+// 한 번 받은 핸들과 뷰는 아레나가 살아 있는 동안 계속 유효합니다. 삭제는 없으며,
+// 죽은 메시지가 많아지면 살아 있는 메시지만 새 아레나로 옮기고 이전 아레나는 참조가 끝날 때 해제합니다.
+// 동시 접근은 소유자(ShortTermMemory)의 잠금으로 보호합니다.
+class MessageArena {
+public:
+    using Handle = uint32_t;
+    
+    Handle append(Message::Role role, std::string_view content, 
+                  std::chrono::system_clock::time_point timestamp);
+    Handle append(const MessageView& message) {
+        return append(message.role, message.content, message.timestamp);
+    }
+    
+    const MessageView& view(Handle handle) const { return records[handle]; }
+    size_t size() const { return records.size(); }
+    
+private:
+    static const size_t blockSize = 64 * 1024;
+    
+    std::vector<std::unique_ptr<char[]>> blocks;
+    std::vector<std::unique_ptr<char[]>> largeBlocks;  // blockSize보다 큰 메시지 전용
+    size_t blockUsed = blockSize;              // 마지막 블록에서 사용한 바이트
+    std::vector<MessageView> records;          // 핸들 -> 메시지
+};
+
+// 잠금 밖으로 넘기는 대화 기록 (아레나 참조를 함께 들고 있어 뷰가 유효함)
+struct ConversationSnapshot {
+    std::shared_ptr<const MessageArena> arena;
+    std::vector<MessageView> messages;
+};
+
+#endif // MESSAGE_ARENA_HPP
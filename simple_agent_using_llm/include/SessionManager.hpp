@@ -0,0 +1,119 @@
+#ifndef SESSION_MANAGER_HPP
+#define SESSION_MANAGER_HPP
+
+#include "MemoryManager.hpp"
+#include "WorkerPool.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+#include <deque>
+#include <list>
+#include <unordered_map>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <utility>
+#include <chrono>
+
+// 한 프로세스에서 여러 사용자의 세션을 동시에 처리하는 관리자
+// 세션마다 단기 기억을 따로 두고 장기 기억(벡터 DB)은 모든 세션이 공유합니다.
+//
+// 세션은 ID 해시로 shardCount개 샤드에 나뉘며 샤드마다 잠금과 LRU 목록이 있습니다.
+// 요청은 세션별 큐에 쌓이고 작업자 풀이 세션당 한 번에 한 턴씩 순서대로 처리하므로,
+// 같은 세션의 턴은 순서가 보장되고 서로 다른 세션은 풀 크기만큼 동시에 처리됩니다.
+// 단기 기억 요약은 턴 처리 풀과 분리된 요약 풀(턴 작업자 수의 절반)에서 실행됩니다.
+// 턴 처리는 UserAgent와 같은 MemoryManager::processTurn이며, 장기 기억 검색은 별도 검색 풀에서 제한 시간 안에 합류합니다.
+// 샤드의 상주 세션이 한도를 넘으면 처리 중이 아닌 가장 오래된 세션의 단기 기억을
+// 디스크에 기록하고 메모리에서 내리며, 그 세션에 다음 메시지가 오면 파일에서 복원합니다.
+// 기록과 복원은 샤드 잠금 밖에서 하므로 같은 샤드의 다른 세션 요청은 디스크 I/O를 기다리지 않습니다.
+class SessionManager {
+public:
+    using ResponseCallback = std::function<void(const std::string& sessionId, const std::string& response)>;
+
+private:
+    struct Turn {
+        std::string query;
+        ResponseCallback onResponse;
+        bool endSession = false;
+    };
+
+    struct Session {
+        std::shared_ptr<ShortTermMemory> shortTerm;
+        std::shared_ptr<MemoryManager> memory;
+        std::deque<Turn> pendingTurns;         // 샤드 잠금 보호
+        bool running = false;                  // 처리 작업이 풀에 올라가 있는지
+        bool needsRestore = true;              // 첫 턴 전에 기록 파일에서 복원해야 하는지
+        bool spilling = false;                 // 잠금 밖에서 디스크에 기록 중 (그동안 새 턴은 큐에만 쌓임)
+        std::list<std::string>::iterator lruPosition;
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<std::string, std::shared_ptr<Session>> sessions;
+        std::list<std::string> lru;            // 앞쪽이 최근 사용
+        size_t spillingCount = 0;              // spilling인 세션 수
+    };
+
+    using SpillVictims = std::vector<std::pair<std::string, std::shared_ptr<Session>>>;
+
+    static const size_t shardCount = 64;
+
+    std::shared_ptr<LLMAgent> llmAgent;
+    std::shared_ptr<LongTermMemory> longTermMemory;
+    std::shared_ptr<WorkerPool> pool;
+    // 요약은 별도 풀에서 실행: 세션 종료 턴이 작업자에서 요약 완료를 기다리므로
+    // 같은 풀을 쓰면 종료 턴들이 모든 작업자를 차지해 요약이 실행되지 못할 수 있음
+    std::shared_ptr<WorkerPool> summaryPool;
+    // 장기 기억 검색 풀: 세션마다 검색은 하나만 진행되므로 백엔드가 멈춰도 스레드와 대기 작업이 제한됨
+    std::shared_ptr<WorkerPool> retrievalPool;
+    std::chrono::milliseconds retrievalTimeout{300};
+    std::shared_ptr<TokenCounter> tokenCounter;
+    std::string spillDirectory;
+    size_t shardCapacity;
+    std::vector<std::unique_ptr<Shard>> shards;
+
+    std::mutex activeMutex;
+    std::condition_variable allIdle;
+    size_t activeSessions = 0;                 // running인 세션 수
+    std::atomic<size_t> evictionCount{0};
+    std::atomic<size_t> restoreCount{0};
+
+    Shard& shardFor(const std::string& sessionId);
+    std::shared_ptr<Session> acquireLocked(Shard& shard, const std::string& sessionId);
+    SpillVictims selectSpillVictimsLocked(Shard& shard);
+    void spillVictims(Shard& shard, const SpillVictims& victims);
+    void enqueue(const std::string& sessionId, Turn turn);
+    void scheduleDrain(const std::string& sessionId, std::shared_ptr<Session> session);
+    void drain(const std::string& sessionId, std::shared_ptr<Session> session);
+    std::string runTurn(Session& session, const std::string& query);
+
+    std::string spillPath(const std::string& sessionId) const;
+    bool spill(const std::string& sessionId, Session& session);  // 실패하면 false (일부 기록된 파일은 지움)
+    bool restore(const std::string& sessionId, Session& session);
+
+public:
+    // workerCount가 0이면 하드웨어 스레드 수의 2배 (LLM 호출 대기가 대부분이므로)
+    // maxResidentSessions: 메모리에 둘 최대 세션 수 (샤드별로 나눠 적용)
+    SessionManager(std::shared_ptr<LLMAgent> agent, std::shared_ptr<VectorDB> db,
+                   size_t workerCount = 0, size_t maxResidentSessions = 1024,
+                   const std::string& spillDirectory = "sessions");
+    // 처리 중인 턴을 모두 끝낸 뒤 상주 세션을 디스크에 기록
+    ~SessionManager();
+
+    SessionManager(const SessionManager&) = delete;
+    SessionManager& operator=(const SessionManager&) = delete;
+
+    // 턴을 세션 큐에 넣고 바로 반환, 응답은 작업자 스레드에서 onResponse로 전달
+    void submit(const std::string& sessionId, const std::string& query, ResponseCallback onResponse);
+    // 응답이 나올 때까지 대기 (작업자 스레드 안에서 호출하면 안 됨)
+    std::string processQuery(const std::string& sessionId, const std::string& query);
+    // 앞선 턴을 마친 뒤 세션을 장기 기억에 저장하고 정리
+    void endSession(const std::string& sessionId);
+
+    size_t residentSessionCount();
+    size_t evictedSessionCount() const { return evictionCount.load(); }
+    size_t restoredSessionCount() const { return restoreCount.load(); }
+};
+
+#endif // SESSION_MANAGER_HPP
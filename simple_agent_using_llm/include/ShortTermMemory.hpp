@@ -2,32 +2,121 @@
 #define SHORT_TERM_MEMORY_HPP
 
 #include "Message.hpp"
+#include "MessageArena.hpp"
 #include "LLMAgent.hpp"
+#include "TokenCounter.hpp"
+#include "WorkerPool.hpp"
 #include <vector>
 #include <string>
 #include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include <unordered_map>
 
+// 컨텍스트 크기와 요약 임계값은 모두 토큰 단위입니다.
+// 메시지별 토큰 수는 추가할 때 한 번만 계산해 두고 합계를 누적하므로 크기 확인은 O(1)입니다.
+//
+// 요약은 백그라운드 작업자 풀에서 합니다 (여러 세션이 풀 하나를 공유할 수 있음). 임계값을 넘으면 오래된 메시지의 스냅샷만 넘기고
+// addMessage는 바로 반환하며, 요약이 끝나면 잠금 아래에서 스냅샷에 해당하는 메시지를 지우고
+// 맨 앞의 요약 메시지를 갱신합니다. 그동안 추가된 메시지는 뒤에 그대로 남습니다.
+//
+// 요약은 계층 구조입니다. 밀려난 메시지는 summaryChunkTokens 이하의 묶음으로 한 번씩만 요약되고 (0단계),
+// 같은 단계의 요약이 summaryFanout개 모이면 그 요약들만 다시 요약해 한 단계 위로 올립니다.
+// 따라서 요약 호출 한 번에 보내는 토큰 수는 대화 길이와 관계없이 제한되며, 같은 입력은 해시로 캐시합니다.
+//
+// 프롬프트용 텍스트와 JSON은 추가 전용 버퍼로 유지해 새 메시지는 끝에 덧붙이기만 하고,
+// 요약이 반영되거나 기록을 지울 때만 다시 만듭니다. 그 사이에는 이전 프롬프트가 다음 프롬프트의
+// 접두사이므로 getPrefixBoundary()로 제공자의 프롬프트(접두사) 캐시 경계를 지정할 수 있습니다.
+//
+// 메시지 내용은 MessageArena에 한 번만 저장하고 기록은 핸들 목록으로 유지합니다.
+// 요약 작업과 세션 저장에는 메시지 복사본 대신 아레나 참조와 뷰를 넘깁니다.
 class ShortTermMemory {
 private:
-    std::vector<Message> conversationHistory;
+    std::shared_ptr<MessageArena> arena;
+    std::vector<MessageArena::Handle> conversationHistory;  // 아레나 핸들 (오래된 순)
     size_t maxContextSize;
     size_t summaryThreshold;
     size_t recentMessagesToKeep;
     std::shared_ptr<LLMAgent> llmAgent;
+    std::shared_ptr<TokenCounter> tokenCounter;
+    std::vector<size_t> messageTokens;  // conversationHistory와 같은 순서의 메시지별 토큰 수
+    size_t currentTokens = 0;
+    
+    // 컨텍스트에 들어가는 역할 이름과 구분자 몫
+    static const size_t messageOverheadTokens = 4;
+    
+    // 백그라운드 요약 상태 (historyMutex 보호)
+    mutable std::mutex historyMutex;
+    std::shared_ptr<WorkerPool> summaryPool;
+    std::condition_variable summaryFinished;
+    std::vector<MessageView> pendingSnapshot;  // 요약할 앞부분 메시지 (비어 있으면 요청 없음)
+    std::shared_ptr<const MessageArena> pendingArena; // pendingSnapshot 뷰가 가리키는 아레나
+    std::vector<size_t> pendingSnapshotTokens;
+    uint64_t pendingGeneration = 0;        // pendingSnapshot을 만든 시점의 historyGeneration
+    bool hasSummaryMessage = false;        // conversationHistory[0]이 요약 메시지인지
+    bool summarizing = false;
+    bool stopping = false;
+    uint64_t historyGeneration = 0;        // clearHistory마다 증가 (이전 기록의 요약 결과 폐기용)
+    
+    // 요약 계층 (한 번에 하나만 실행되는 요약 작업만 사용)
+    static const size_t summaryChunkTokens = 2048;
+    static const size_t summaryFanout = 4;
+    static const size_t summaryCacheLimit = 1024;
+    std::vector<std::vector<std::string>> summaryLevels;  // 단계별 아직 병합되지 않은 요약
+    std::unordered_map<uint64_t, std::string> summaryCache; // 입력 해시 -> 요약
+    uint64_t summaryTreeGeneration = 0;
+    
+    std::string summarizeCached(const std::vector<MessageView>& messages);
+    void addSummary(size_t level, std::string summary);
+    std::string composeSummary() const;
+    
+    // 직렬화된 기록 (historyMutex 보호)
+    std::string contextBuffer;             // "role: content\n\n" 반복
+    std::string jsonBuffer;                // 대괄호를 뺀 JSON 배열 원소들
+    mutable size_t lastPromptLength = 0;   // 마지막으로 내준 프롬프트 길이
+    uint64_t prefixVersion = 0;            // 접두사가 무효화될 때마다 증가
+    
+    void appendMessage(Message::Role role, std::string_view content,
+                       std::chrono::system_clock::time_point timestamp, size_t tokens);
+    void appendSerialized(const MessageView& message);
+    void compactArenaIfNeeded();
+    void rebuildSerialized();
+    void scheduleSummaryLocked();
+    void runSummary();
     
 public:
     ShortTermMemory(std::shared_ptr<LLMAgent> agent, 
-                   size_t maxSize = 10000, 
-                   size_t threshold = 8000, 
-                   size_t keepRecent = 5);
+                   size_t maxTokens = 8192, 
+                   size_t thresholdTokens = 6144, 
+                   size_t keepRecent = 5,
+                   std::shared_ptr<TokenCounter> counter = nullptr,
+                   std::shared_ptr<WorkerPool> pool = nullptr);  // 없으면 전용 스레드 하나
+    ~ShortTermMemory();
+    
+    ShortTermMemory(const ShortTermMemory&) = delete;
+    ShortTermMemory& operator=(const ShortTermMemory&) = delete;
     
     void addMessage(const Message& message);
-    size_t getCurrentContextSize() const;
-    void summarizeOlderMessages();
+    void addMessage(Message::Role role, std::string_view content);  // Message를 만들지 않고 바로 아레나에 저장
+    size_t getCurrentContextSize() const;  // 토큰 수
+    void summarizeOlderMessages();         // 요약 요청만 하고 반환
+    void waitForSummarization();           // 진행 중인 요약이 반영될 때까지 대기
+    bool isSummarizing() const;
     std::string getContextForNewQuery(const std::string& newQuery) const;
+    // 현재 컨텍스트 중 직전 getContextForNewQuery 결과와 같은 앞부분의 길이 (바이트)
+    size_t getPrefixBoundary() const;
+    // 요약 반영이나 기록 삭제로 접두사가 바뀔 때마다 증가하는 값
+    uint64_t getPrefixVersion() const;
     std::string getConversationHistoryJSON() const;
-    std::vector<Message> getConversationHistory() const;
+    std::vector<Message> getConversationHistory() const;  // 복사본 (가능하면 getConversationSnapshot 사용)
+    ConversationSnapshot getConversationSnapshot() const;  // 메시지 복사 없음
     void clearHistory();
+    
+    // 저장해 둔 기록으로 복원 (세션 축출 후 재적재용, 요약은 실행하지 않음)
+    // firstIsSummary: messages[0]이 이 클래스가 만든 요약 메시지인지
+    void restoreHistory(const std::vector<Message>& messages, bool firstIsSummary);
+    bool hasSummary() const;
 };
 
 #endif // SHORT_TERM_MEMORY_HPP
@@ -0,0 +1,32 @@
+#ifndef TOKEN_COUNTER_HPP
+#define TOKEN_COUNTER_HPP
+
+#include <string>
+#include <string_view>
+#include <memory>
+
+#ifdef HAVE_SENTENCEPIECE
+#include <sentencepiece_processor.h>
+#endif
+
+// 텍스트의 토큰 수 계산
+// sentencepiece가 있으면 모델로 실제 토큰화하고 (vectorDB 모듈과 같은 토크나이저),
+// 없거나 모델을 불러오지 못하면 근사값을 씁니다 (영문/숫자 4바이트당 1토큰, 한글 등 비ASCII 문자당 1토큰).
+class TokenCounter {
+private:
+#ifdef HAVE_SENTENCEPIECE
+    std::unique_ptr<sentencepiece::SentencePieceProcessor> processor;
+#endif
+    bool modelLoaded = false;
+    
+    static size_t approximateCount(std::string_view text);
+    
+public:
+    // modelPath가 비어 있으면 환경 변수 SENTENCEPIECE_MODEL의 경로 사용
+    explicit TokenCounter(const std::string& modelPath = "");
+    
+    size_t count(std::string_view text) const;
+    bool usesTokenizer() const { return modelLoaded; }
+};
+
+#endif // TOKEN_COUNTER_HPP
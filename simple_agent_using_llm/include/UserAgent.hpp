@@ -3,9 +3,12 @@
 
 #include "MemoryManager.hpp"
 #include "LLMAgent.hpp"
+#include "WorkerPool.hpp"
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
+#include <chrono>
 
 class UserAgent {
 private:
@@ -13,8 +16,18 @@ private:
     std::unordered_map<std::string, std::shared_ptr<LLMAgent>> llmAgents;
     std::string currentAgentId;
     
+    // 장기 기억 검색 제한 시간 (넘으면 검색 결과 없이 응답 생성)
+    std::chrono::milliseconds retrievalTimeout;
+    // 검색 전용 작업자 하나 (임베딩 백엔드가 멈춰도 스레드가 늘지 않음, 소멸 시 남은 검색을 기다림)
+    std::unique_ptr<WorkerPool> retrievalPool;
+    
 public:
     UserAgent();
+    ~UserAgent();
+    
+    void setRetrievalTimeout(std::chrono::milliseconds timeout);
+    size_t getRetrievalTimeoutCount() const { return memoryManager->getRetrievalTimeoutCount(); }
+    size_t getSkippedRetrievalCount() const { return memoryManager->getSkippedRetrievalCount(); }
     
     bool switchAgent(const std::string& agentId);
     std::string processQuery(const std::string& query);
@@ -5,6 +5,11 @@
 #include <string>
 #include <unordered_map>
 #include <fstream>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
 
 // Vector DB 인터페이스 클래스
 class VectorDB {
@@ -17,25 +22,73 @@ public:
 };
 
 // 간단한 Vector DB 구현
+// 임베딩은 저장 시 정규화해 행 우선(row-major) 연속 행렬에 보관하므로,
+// 검색은 쿼리와 각 행의 내적(SIMD)만 계산하고 상위 topK개만 힙으로 유지합니다.
+//
+// 영속화는 추가 전용(append-only) 로그로 합니다.
+// 로그 파일: 매직 "SVDBLOG1" + 레코드 [길이 u32][CRC32 u32][ID, 임베딩, 메타데이터]
+// store는 레코드를 메모리 버퍼에 붙이기만 하고, 백그라운드 스레드가 commitInterval마다
+// 모인 레코드를 한 번에 쓰고 fsync합니다 (그룹 커밋). 따라서 장애 시 최대 commitInterval 동안의
+// 저장분을 잃을 수 있으며, 즉시 내구성이 필요하면 persistToDisk()를 호출합니다.
+// 덮어쓰기로 죽은 레코드가 살아 있는 항목 수만큼 쌓이면 현재 내용으로 로그를 새로 씁니다 (압축).
 class SimpleVectorDB : public VectorDB {
 private:
-    struct Entry {
-        std::vector<float> embedding;
-        std::string metadata;
-    };
+    size_t dimension = 0;                           // 첫 저장 시 결정 (이후 다른 차원은 거부)
+    std::vector<float> matrix;                      // 정규화된 임베딩 (행 = 항목)
+    std::vector<std::string> ids;                   // 행 -> ID
+    std::vector<std::string> metadata;              // 행 -> 메타데이터
+    std::unordered_map<std::string, size_t> rowIndex; // ID -> 행
     
-    std::unordered_map<std::string, Entry> database;
+    // 로그 상태 (logMutex 보호)
+    std::string logPath;
+    std::chrono::milliseconds commitInterval;
+    int logFd = -1;
+    size_t logSize = 0;                             // 마지막으로 성공한 기록까지의 로그 크기 (다음 기록 위치)
+    size_t logRecords = 0;                          // 로그에 있는 레코드 수 (죽은 레코드 포함)
+    std::string pending;                            // 아직 쓰지 않은 레코드
+    std::string compactImage;                       // 비어 있지 않으면 로그를 이 내용으로 교체
+    uint64_t appendedSeq = 0;                       // 버퍼에 추가된 마지막 순번
+    uint64_t durableSeq = 0;                        // fsync까지 끝난 마지막 순번
+    uint64_t failedSeq = 0;                         // 마지막으로 실패한 기록이 포함한 순번
+    uint64_t failedAttempts = 0;                    // 실패한 기록 횟수 (실패는 다음 주기에 재시도)
+    int flushWaiters = 0;                           // persistToDisk 대기 중인 호출 수
+    bool stopping = false;
+    std::mutex logMutex;
+    std::condition_variable flushRequested;
+    std::condition_variable flushed;
+    std::thread committer;
     
-    float cosineSimilarity(const std::vector<float>& vec1, const std::vector<float>& vec2);
+    // 단위 벡터로 정규화해 out에 기록 (embedding 크기는 dimension과 같아야 함)
+    void normalizeInto(const std::vector<float>& embedding, float* out) const;
+    
+    static float dotProduct(const float* a, const float* b, size_t n);
+    
+    // 로그 없이 메모리 행렬에만 반영 (로그 재생과 store가 공유)
+    size_t upsertRow(const std::string& id, const std::string& meta);
+    
+    void appendRecord(std::string& out, size_t row) const;
+    void commitLoop();
     
 public:
+    explicit SimpleVectorDB(const std::string& path = "vector_db.data",
+                            std::chrono::milliseconds commitInterval = std::chrono::milliseconds(50));
+    ~SimpleVectorDB() override;
+    
+    SimpleVectorDB(const SimpleVectorDB&) = delete;
+    SimpleVectorDB& operator=(const SimpleVectorDB&) = delete;
+    
     void store(const std::string& id, const std::vector<float>& embedding, 
               const std::string& metadata) override;
               
     std::vector<std::pair<std::string, float>> search(
         const std::vector<float>& queryEmbedding, int topK) override;
     
-    void persistToDisk();
+    size_t size() const { return ids.size(); }
+    
+    // 지금까지 저장한 내용이 디스크에 기록(fsync)될 때까지 대기
+    // 대기 중 기록이 실패하면 false (내용은 메모리에 남아 다음 주기에 다시 기록을 시도)
+    bool persistToDisk();
+    // 로그를 재생해 메모리 행렬을 복원 (생성자에서 호출, 손상된 꼬리는 잘라냄)
     void loadFromDisk();
 };
 
@@ -0,0 +1,37 @@
+#ifndef WORKER_POOL_HPP
+#define WORKER_POOL_HPP
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// 고정 크기 작업자 스레드 풀
+// 세션 처리와 요약처럼 오래 걸리는 작업을 스레드 수 제한 안에서 실행합니다.
+// 소멸 시 대기 중인 작업을 모두 끝낸 뒤 스레드를 정리합니다.
+// 작업에서 나온 예외는 stderr에 기록하고 다음 작업을 계속 처리합니다.
+class WorkerPool {
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex queueMutex;
+    std::condition_variable taskAvailable;
+    bool stopping = false;
+    
+    void workerLoop();
+    
+public:
+    explicit WorkerPool(size_t threadCount);
+    ~WorkerPool();
+    
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+    
+    void submit(std::function<void()> task);
+    size_t queueDepth();
+    size_t size() const { return workers.size(); }
+};
+
+#endif // WORKER_POOL_HPP
@@ -0,0 +1,123 @@
+#include "JsonWriter.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+inline bool needsEscape(unsigned char c) {
+    return c < 0x20 || c == '"' || c == '\\';
+}
+
+// text[from..]에서 이스케이프가 필요한 첫 바이트 위치 (없으면 text.size())
+size_t findEscape(std::string_view text, size_t from) {
+    const char* data = text.data();
+    size_t n = text.size();
+    size_t i = from;
+    
+#if defined(__SSE2__)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control = _mm_set1_epi8(0x1F);
+    for (; i + 16 <= n; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        // 부호 없는 비교: min(c, 0x1F) == c 이면 c <= 0x1F
+        __m128i hits = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+            _mm_cmpeq_epi8(_mm_min_epu8(chunk, control), chunk));
+        int mask = _mm_movemask_epi8(hits);
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    const uint8x16_t quote = vdupq_n_u8('"');
+    const uint8x16_t backslash = vdupq_n_u8('\\');
+    const uint8x16_t control = vdupq_n_u8(0x20);
+    for (; i + 16 <= n; i += 16) {
+        uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(data + i));
+        uint8x16_t hits = vorrq_u8(vorrq_u8(vceqq_u8(chunk, quote), vceqq_u8(chunk, backslash)),
+                                   vcltq_u8(chunk, control));
+        if (vmaxvq_u8(hits) != 0) {
+            break; // 이 16바이트 안의 정확한 위치는 아래 스칼라 루프로
+        }
+    }
+#endif
+    
+    for (; i < n; i++) {
+        if (needsEscape(static_cast<unsigned char>(data[i]))) {
+            return i;
+        }
+    }
+    return n;
+}
+
+} // namespace
+
+void JsonWriter::appendEscaped(std::string& out, std::string_view text) {
+    static const char hex[] = "0123456789abcdef";
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t special = findEscape(text, start);
+        out.append(text.data() + start, special - start);
+        if (special == text.size()) {
+            break;
+        }
+        
+        unsigned char c = static_cast<unsigned char>(text[special]);
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            default: {
+                char escaped[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+                out.append(escaped, sizeof(escaped));
+            }
+        }
+        start = special + 1;
+    }
+}
+
+void JsonWriter::separate() {
+    if (needsComma) {
+        buffer += ',';
+    }
+    needsComma = true;
+}
+
+JsonWriter& JsonWriter::beginObject() {
+    separate();
+    buffer += '{';
+    needsComma = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::endObject() {
+    buffer += '}';
+    needsComma = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(std::string_view name) {
+    separate();
+    buffer += '"';
+    appendEscaped(buffer, name);
+    buffer += "\":";
+    needsComma = false; // 바로 뒤의 값 앞에는 쉼표 없음
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(std::string_view text) {
+    separate();
+    buffer += '"';
+    appendEscaped(buffer, text);
+    buffer += '"';
+    return *this;
+}
@@ -12,7 +12,7 @@ std::vector<float> ChatGPTAgent::generateEmbedding(const std::string& text) {
     return std::vector<float>{0.1f, 0.2f}; // 예시
 }
 
-std::string ChatGPTAgent::summarizeConversation(const std::vector<Message>& messages) {
+std::string ChatGPTAgent::summarizeConversation(const std::vector<MessageView>& messages) {
     std::stringstream prompt;
     prompt << "다음 대화를 간결하게 요약해주세요:\n\n";
     
@@ -34,7 +34,7 @@ std::vector<float> ClaudeAgent::generateEmbedding(const std::string& text) {
     return std::vector<float>{0.3f, 0.4f}; // 예시
 }
 
-std::string ClaudeAgent::summarizeConversation(const std::vector<Message>& messages) {
+std::string ClaudeAgent::summarizeConversation(const std::vector<MessageView>& messages) {
     std::stringstream prompt;
     prompt << "Please summarize the following conversation concisely:\n\n";
     
@@ -1,23 +1,33 @@
 #include "LongTermMemory.hpp"
+#include "JsonWriter.hpp"
+#include <chrono>
 
 LongTermMemory::LongTermMemory(std::shared_ptr<VectorDB> db, std::shared_ptr<LLMAgent> agent)
     : vectorDB(db), llmAgent(agent) {}
 
-void LongTermMemory::storeConversation(const std::string& sessionId, const std::vector<Message>& conversation) {
+void LongTermMemory::storeConversation(const std::string& sessionId, const std::vector<MessageView>& conversation) {
     std::string conversationText;
     for (const auto& msg : conversation) {
-        conversationText += msg.getRoleString() + ": " + msg.content + "\n";
+        conversationText += msg.getRoleString();
+        conversationText += ": ";
+        conversationText += msg.content;
+        conversationText += "\n";
     }
     
     std::vector<float> embedding = llmAgent->generateEmbedding(conversationText);
     
-    std::stringstream metadata;
-    metadata << "{\"session_id\":\"" << sessionId 
-             << "\",\"timestamp\":\"" << std::chrono::system_clock::now().time_since_epoch().count()
-             << "\",\"conversation\":\"" << conversationText << "\"}";
+    // 대화 전체가 들어가므로 스레드별 버퍼를 재사용하고 내용은 이스케이프
+    thread_local std::string metadata;
+    metadata.clear();
+    JsonWriter writer(metadata);
+    writer.beginObject()
+          .key("session_id").value(sessionId)
+          .key("timestamp").value(std::to_string(std::chrono::system_clock::now().time_since_epoch().count()))
+          .key("conversation").value(conversationText)
+          .endObject();
     
     std::lock_guard<std::mutex> lock(dbMutex);
-    vectorDB->store(sessionId, embedding, metadata.str());
+    vectorDB->store(sessionId, embedding, metadata);
 }
 
 std::vector<std::string> LongTermMemory::retrieveSimilarConversations(const std::string& query, int topK) {
@@ -6,6 +6,10 @@ MemoryManager::MemoryManager(std::shared_ptr<LLMAgent> agent, std::shared_ptr<Ve
     currentSessionId = generateSessionId();
 }
 
+MemoryManager::MemoryManager(std::shared_ptr<ShortTermMemory> shortTerm, std::shared_ptr<LongTermMemory> longTerm,
+                             const std::string& sessionId)
+    : shortTermMemory(shortTerm), longTermMemory(longTerm), currentSessionId(sessionId) {}
+
 std::string MemoryManager::generateSessionId() {
     auto now = std::chrono::system_clock::now();
     return "session_" + std::to_string(now.time_since_epoch().count());
@@ -18,18 +22,19 @@ void MemoryManager::startNewSession() {
 }
 
 void MemoryManager::saveCurrentSession() {
-    auto conversation = shortTermMemory->getConversationHistory();
-    if (!conversation.empty()) {
-        longTermMemory->storeConversation(currentSessionId, conversation);
+    // 복사 없이 아레나의 뷰로 전달
+    ConversationSnapshot conversation = shortTermMemory->getConversationSnapshot();
+    if (!conversation.messages.empty()) {
+        longTermMemory->storeConversation(currentSessionId, conversation.messages);
     }
 }
 
 void MemoryManager::addUserMessage(const std::string& message) {
-    shortTermMemory->addMessage(Message(Message::Role::USER, message));
+    shortTermMemory->addMessage(Message::Role::USER, message);
 }
 
 void MemoryManager::addAssistantResponse(const std::string& response) {
-    shortTermMemory->addMessage(Message(Message::Role::ASSISTANT, response));
+    shortTermMemory->addMessage(Message::Role::ASSISTANT, response);
 }
 
 std::string MemoryManager::preparePromptForNewQuery(const std::string& newQuery) {
@@ -40,6 +45,63 @@ std::vector<std::string> MemoryManager::retrieveRelevantConversations(const std:
     return longTermMemory->retrieveSimilarConversations(query, topK);
 }
 
+MemoryManager::TurnResult MemoryManager::processTurn(LLMAgent& agent, const std::string& query,
+                                                     WorkerPool& retrievalPool,
+                                                     std::chrono::milliseconds retrievalTimeout) {
+    // 사용자 메시지 저장
+    addUserMessage(query);
+    
+    // 장기 기억에서 관련 대화 검색 (필요시)
+    // 임베딩 호출이 포함되어 느리므로 단기 기억 프롬프트 준비와 동시에 진행
+    // 이전 턴의 검색이 아직 끝나지 않았으면 (백엔드 지연) 이번 턴은 검색 없이 진행
+    std::future<std::vector<std::string>> retrieval;
+    if (query.length() > 0) { // 간단한 예시 조건
+        if (lateRetrieval.valid() &&
+            lateRetrieval.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            skippedRetrievals++;
+        } else {
+            lateRetrieval = std::future<std::vector<std::string>>();
+            auto promise = std::make_shared<std::promise<std::vector<std::string>>>();
+            retrieval = promise->get_future();
+            // 이 객체보다 오래 남을 수 있으므로 장기 기억만 붙잡음
+            std::shared_ptr<LongTermMemory> longTerm = longTermMemory;
+            retrievalPool.submit([promise, longTerm, query] {
+                try {
+                    promise->set_value(longTerm->retrieveSimilarConversations(query, 3));
+                } catch (...) {
+                    promise->set_exception(std::current_exception());
+                }
+            });
+        }
+    }
+    
+    // 관련 컨텍스트 준비
+    TurnResult turn;
+    turn.prompt = preparePromptForNewQuery(query);
+    
+    // 생성 직전에 검색 결과 합류 (제한 시간을 넘기면 검색 결과 없이 진행)
+    std::vector<std::string> relevantConversations;
+    if (retrieval.valid()) {
+        if (retrieval.wait_for(retrievalTimeout) == std::future_status::ready) {
+            relevantConversations = retrieval.get();
+        } else {
+            retrievalTimeouts++;
+            lateRetrieval = std::move(retrieval);
+        }
+    }
+    
+    // 관련 대화가 있으면 프롬프트 끝(새 질문 바로 뒤)에 추가
+    // 턴마다 바뀌는 검색 결과를 앞에 두면 단기 기억 접두사(getPrefixBoundary)가 매번 달라져 프롬프트 캐시를 쓸 수 없음
+    if (!relevantConversations.empty()) {
+        turn.prompt += "참고: 다음은 이전에 유사한 주제로 나눈 대화입니다:\n\n" + relevantConversations[0] + "\n\n";
+    }
+    
+    // 응답 생성 및 저장
+    turn.response = agent.generateResponse(turn.prompt);
+    addAssistantResponse(turn.response);
+    return turn;
+}
+
 std::shared_ptr<ShortTermMemory> MemoryManager::getShortTermMemory() {
     return shortTermMemory;
 }
@@ -47,3 +109,7 @@ std::shared_ptr<ShortTermMemory> MemoryManager::getShortTermMemory() {
 std::shared_ptr<LongTermMemory> MemoryManager::getLongTermMemory() {
     return longTermMemory;
 }
+
+const std::string& MemoryManager::getSessionId() const {
+    return currentSessionId;
+}
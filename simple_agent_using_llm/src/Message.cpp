@@ -1,14 +1,37 @@
 #include "Message.hpp"
+#include "JsonWriter.hpp"
 
-Message::Message(Role r, const std::string& c) 
-    : role(r), content(c), timestamp(std::chrono::system_clock::now()) {}
+Message::Message(Role r, std::string c) 
+    : role(r), content(std::move(c)), timestamp(std::chrono::system_clock::now()) {}
 
 std::string Message::getRoleString() const {
     return role == Role::USER ? "user" : "assistant";
 }
 
 std::string Message::toJSON() const {
-    std::stringstream ss;
-    ss << "{\"role\":\"" << getRoleString() << "\",\"content\":\"" << content << "\"}";
-    return ss.str();
+    return MessageView{role, content, timestamp}.toJSON();
+}
+
+std::string MessageView::getRoleString() const {
+    return role == Message::Role::USER ? "user" : "assistant";
+}
+
+std::string MessageView::toJSON() const {
+    std::string json;
+    JsonWriter writer(json);
+    writeJSON(writer);
+    return json;
+}
+
+void MessageView::writeJSON(JsonWriter& writer) const {
+    writer.beginObject()
+          .key("role").value(role == Message::Role::USER ? "user" : "assistant")
+          .key("content").value(content)
+          .endObject();
+}
+
+Message MessageView::toMessage() const {
+    Message message(role, std::string(content));
+    message.timestamp = timestamp;
+    return message;
 }
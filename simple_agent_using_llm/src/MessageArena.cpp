@@ -0,0 +1,27 @@
+#include "MessageArena.hpp"
+#include <cstring>
+
+MessageArena::Handle MessageArena::append(Message::Role role, std::string_view content,
+                                          std::chrono::system_clock::time_point timestamp) {
+    const char* stored = "";
+    if (!content.empty()) {
+        if (content.size() > blockSize) {
+            // 블록보다 큰 메시지는 전용 블록 (현재 블록은 계속 사용)
+            largeBlocks.push_back(std::make_unique<char[]>(content.size()));
+            std::memcpy(largeBlocks.back().get(), content.data(), content.size());
+            stored = largeBlocks.back().get();
+        } else {
+            if (blockUsed + content.size() > blockSize) {
+                blocks.push_back(std::make_unique<char[]>(blockSize));
+                blockUsed = 0;
+            }
+            char* target = blocks.back().get() + blockUsed;
+            std::memcpy(target, content.data(), content.size());
+            blockUsed += content.size();
+            stored = target;
+        }
+    }
+    
+    records.push_back(MessageView{role, std::string_view(stored, content.size()), timestamp});
+    return static_cast<Handle>(records.size() - 1);
+}
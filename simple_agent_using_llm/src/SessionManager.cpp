@@ -0,0 +1,354 @@
+#include "SessionManager.hpp"
+#include <fstream>
+#include <algorithm>
+#include <cctype>
+#include <future>
+#include <thread>
+#include <cstdio>
+#include <cstdint>
+#include <iostream>
+#include <sys/stat.h>
+
+namespace {
+
+const char spillMagic[8] = {'S', 'E', 'S', 'S', '0', '0', '0', '1'};
+
+template <typename T>
+void writeValue(std::ofstream& out, T value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+bool readValue(std::ifstream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+} // namespace
+
+SessionManager::SessionManager(std::shared_ptr<LLMAgent> agent, std::shared_ptr<VectorDB> db,
+                               size_t workerCount, size_t maxResidentSessions,
+                               const std::string& spillDir)
+    : llmAgent(agent),
+      longTermMemory(std::make_shared<LongTermMemory>(db, agent)),
+      pool(std::make_shared<WorkerPool>(workerCount ? workerCount : std::max(2u, std::thread::hardware_concurrency() * 2))),
+      summaryPool(std::make_shared<WorkerPool>(std::max<size_t>(1, pool->size() / 2))),
+      retrievalPool(std::make_shared<WorkerPool>(std::max<size_t>(1, pool->size() / 2))),
+      tokenCounter(std::make_shared<TokenCounter>()),
+      spillDirectory(spillDir),
+      shardCapacity(std::max<size_t>(1, (maxResidentSessions + shardCount - 1) / shardCount)) {
+    for (size_t i = 0; i < shardCount; i++) {
+        shards.push_back(std::make_unique<Shard>());
+    }
+    mkdir(spillDirectory.c_str(), 0755);
+}
+
+SessionManager::~SessionManager() {
+    {
+        std::unique_lock<std::mutex> lock(activeMutex);
+        allIdle.wait(lock, [this] { return activeSessions == 0; });
+    }
+
+    // 재시작 후에도 이어서 대화할 수 있도록 상주 세션을 모두 기록
+    for (auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        for (auto& entry : shard->sessions) {
+            entry.second->shortTerm->waitForSummarization();
+            spill(entry.first, *entry.second);
+        }
+        shard->sessions.clear();
+        shard->lru.clear();
+    }
+}
+
+SessionManager::Shard& SessionManager::shardFor(const std::string& sessionId) {
+    return *shards[std::hash<std::string>()(sessionId) % shardCount];
+}
+
+std::shared_ptr<SessionManager::Session> SessionManager::acquireLocked(Shard& shard, const std::string& sessionId) {
+    auto it = shard.sessions.find(sessionId);
+    if (it != shard.sessions.end()) {
+        // LRU 맨 앞으로
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second->lruPosition);
+        return it->second;
+    }
+
+    // 기록 파일 복원은 첫 턴을 처리하는 작업자가 잠금 밖에서 (needsRestore)
+    auto session = std::make_shared<Session>();
+    session->shortTerm = std::make_shared<ShortTermMemory>(llmAgent, 8192, 6144, 5, tokenCounter, summaryPool);
+    session->memory = std::make_shared<MemoryManager>(session->shortTerm, longTermMemory, sessionId);
+    shard.lru.push_front(sessionId);
+    session->lruPosition = shard.lru.begin();
+    shard.sessions[sessionId] = session;
+    return session;
+}
+
+SessionManager::SpillVictims SessionManager::selectSpillVictimsLocked(Shard& shard) {
+    // 뒤(오래된 쪽)부터 처리 중이 아니고 요약 중이 아닌 세션을 골라 spilling으로 표시
+    // 이미 기록 중인 세션은 곧 빠질 것이므로 한도 계산에서 제외
+    SpillVictims victims;
+    size_t remaining = shard.sessions.size() - shard.spillingCount;
+    for (auto it = shard.lru.rbegin(); it != shard.lru.rend() && remaining > shardCapacity; ++it) {
+        std::shared_ptr<Session>& session = shard.sessions.find(*it)->second;
+        if (session->running || session->spilling || !session->pendingTurns.empty() ||
+            session->shortTerm->isSummarizing()) {
+            continue;
+        }
+        session->spilling = true;
+        shard.spillingCount++;
+        remaining--;
+        victims.emplace_back(*it, session);
+    }
+    return victims;
+}
+
+void SessionManager::spillVictims(Shard& shard, const SpillVictims& victims) {
+    for (const auto& victim : victims) {
+        // spilling인 동안에는 이 세션의 턴이 실행되지 않으므로 잠금 없이 기록해도 기록이 바뀌지 않음
+        bool written = spill(victim.first, *victim.second);
+        bool schedule = false;
+        bool evicted = false;
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            Session& session = *victim.second;
+            session.spilling = false;
+            shard.spillingCount--;
+            if (written && session.pendingTurns.empty()) {
+                shard.lru.erase(session.lruPosition);
+                shard.sessions.erase(victim.first);
+                evicted = true;
+            } else if (!session.pendingTurns.empty()) {
+                // 기록하는 동안 새 턴이 왔으면 상주를 유지하고 미뤄 둔 처리를 시작
+                session.running = true;
+                schedule = true;
+            }
+            // 기록에 실패하면 대화를 잃지 않도록 한도를 넘더라도 메모리에 남김
+        }
+        if (evicted) {
+            evictionCount++;
+        } else if (written) {
+            // 메모리에 남은 세션의 파일은 쓰이지 않음 (다시 내리거나 종료할 때 새로 기록)
+            std::remove(spillPath(victim.first).c_str());
+        }
+        if (schedule) {
+            scheduleDrain(victim.first, victim.second);
+        }
+    }
+}
+
+void SessionManager::submit(const std::string& sessionId, const std::string& query, ResponseCallback onResponse) {
+    Turn turn;
+    turn.query = query;
+    turn.onResponse = std::move(onResponse);
+    enqueue(sessionId, std::move(turn));
+}
+
+std::string SessionManager::processQuery(const std::string& sessionId, const std::string& query) {
+    auto promise = std::make_shared<std::promise<std::string>>();
+    std::future<std::string> response = promise->get_future();
+    submit(sessionId, query, [promise](const std::string&, const std::string& text) {
+        promise->set_value(text);
+    });
+    return response.get();
+}
+
+void SessionManager::endSession(const std::string& sessionId) {
+    Turn turn;
+    turn.endSession = true;
+    enqueue(sessionId, std::move(turn));
+}
+
+void SessionManager::enqueue(const std::string& sessionId, Turn turn) {
+    Shard& shard = shardFor(sessionId);
+    std::shared_ptr<Session> session;
+    bool schedule = false;
+    SpillVictims victims;
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        session = acquireLocked(shard, sessionId);
+        session->pendingTurns.push_back(std::move(turn));
+        // 기록 중인 세션은 기록을 마친 쪽(spillVictims)이 처리를 시작
+        if (!session->running && !session->spilling) {
+            session->running = true;
+            schedule = true;
+        }
+        victims = selectSpillVictimsLocked(shard);
+    }
+
+    if (schedule) {
+        scheduleDrain(sessionId, session);
+    }
+    // 디스크 기록은 샤드 잠금을 놓은 뒤
+    spillVictims(shard, victims);
+}
+
+void SessionManager::scheduleDrain(const std::string& sessionId, std::shared_ptr<Session> session) {
+    {
+        std::lock_guard<std::mutex> lock(activeMutex);
+        activeSessions++;
+    }
+    pool->submit([this, sessionId, session] { drain(sessionId, session); });
+}
+
+void SessionManager::drain(const std::string& sessionId, std::shared_ptr<Session> session) {
+    Shard& shard = shardFor(sessionId);
+    Turn turn;
+    bool restoreFirst;
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        turn = std::move(session->pendingTurns.front());
+        session->pendingTurns.pop_front();
+        restoreFirst = session->needsRestore;
+        session->needsRestore = false;
+    }
+
+    // 한 턴의 실패(LLM 호출 오류 등)가 작업자 밖으로 나가면 서버 전체가 종료되므로 여기서 처리하고
+    // 아래에서 running과 activeSessions는 항상 정리
+    std::string response;
+    bool ended = false;
+    try {
+        // 새로 만든 세션이면 이전에 내린 기록을 먼저 복원 (running인 동안은 이 작업자만 세션을 사용)
+        if (restoreFirst && restore(sessionId, *session)) {
+            restoreCount++;
+        }
+        if (turn.endSession) {
+            session->shortTerm->waitForSummarization();
+            session->memory->saveCurrentSession();
+            ended = true;
+        } else {
+            response = runTurn(*session, turn.query);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "세션 " << sessionId << " 처리 실패: " << e.what() << std::endl;
+        response = std::string("요청을 처리하지 못했습니다: ") + e.what();
+    } catch (...) {
+        std::cerr << "세션 " << sessionId << " 처리 실패: 알 수 없는 오류" << std::endl;
+        response = "요청을 처리하지 못했습니다.";
+    }
+    if (!turn.endSession && turn.onResponse) {
+        try {
+            turn.onResponse(sessionId, response);
+        } catch (const std::exception& e) {
+            std::cerr << "세션 " << sessionId << " 응답 전달 실패: " << e.what() << std::endl;
+        }
+    }
+
+    bool more;
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (ended && session->pendingTurns.empty()) {
+            // 저장을 마친 세션은 메모리와 디스크에서 모두 정리 (저장에 실패했으면 그대로 둠)
+            shard.lru.erase(session->lruPosition);
+            shard.sessions.erase(sessionId);
+            std::remove(spillPath(sessionId).c_str());
+        }
+        more = !session->pendingTurns.empty();
+        session->running = more;
+    }
+
+    if (more) {
+        // 한 세션이 작업자를 독점하지 않도록 다음 턴은 풀 뒤로 다시 넣음
+        pool->submit([this, sessionId, session] { drain(sessionId, session); });
+        return;
+    }
+    std::lock_guard<std::mutex> lock(activeMutex);
+    activeSessions--;
+    allIdle.notify_all();
+}
+
+std::string SessionManager::runTurn(Session& session, const std::string& query) {
+    // UserAgent::processQuery와 같은 턴 처리 (검색은 크기가 고정된 검색 풀에서, 제한 시간을 넘기면 결과 없이)
+    return session.memory->processTurn(*llmAgent, query, *retrievalPool, retrievalTimeout).response;
+}
+
+size_t SessionManager::residentSessionCount() {
+    size_t count = 0;
+    for (auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        count += shard->sessions.size();
+    }
+    return count;
+}
+
+std::string SessionManager::spillPath(const std::string& sessionId) const {
+    // 파일 이름에 쓸 수 없는 문자는 %XX로
+    static const char hex[] = "0123456789ABCDEF";
+    std::string name;
+    for (unsigned char c : sessionId) {
+        if (std::isalnum(c) || c == '_' || c == '-') {
+            name += static_cast<char>(c);
+        } else {
+            name += '%';
+            name += hex[c >> 4];
+            name += hex[c & 0xF];
+        }
+    }
+    return spillDirectory + "/" + name + ".session";
+}
+
+// 파일 형식: 매직 "SESS0001", 요약 여부 u8, 메시지 수 u32,
+// 메시지마다 역할 u8, 시각 i64(에폭 이후 system_clock 단위), 내용 길이 u32, 내용
+bool SessionManager::spill(const std::string& sessionId, Session& session) {
+    ConversationSnapshot snapshot = session.shortTerm->getConversationSnapshot();
+    const std::vector<MessageView>& history = snapshot.messages;
+    std::string path = spillPath(sessionId);
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        std::cerr << "세션 " << sessionId << "을(를) 기록할 파일을 열 수 없습니다: " << path << std::endl;
+        return false;
+    }
+    out.write(spillMagic, sizeof(spillMagic));
+    writeValue<uint8_t>(out, session.shortTerm->hasSummary() ? 1 : 0);
+    writeValue<uint32_t>(out, static_cast<uint32_t>(history.size()));
+    for (const auto& msg : history) {
+        writeValue<uint8_t>(out, msg.role == Message::Role::USER ? 0 : 1);
+        writeValue<int64_t>(out, static_cast<int64_t>(msg.timestamp.time_since_epoch().count()));
+        writeValue<uint32_t>(out, static_cast<uint32_t>(msg.content.size()));
+        out.write(msg.content.data(), msg.content.size());
+    }
+    out.close();
+    if (out.fail()) {
+        // 일부만 기록된 파일은 복원 시 잘못 읽히지 않도록 지움
+        std::cerr << "세션 " << sessionId << " 기록 실패: " << path << std::endl;
+        std::remove(path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool SessionManager::restore(const std::string& sessionId, Session& session) {
+    std::string path = spillPath(sessionId);
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        return false;
+    }
+
+    char magic[sizeof(spillMagic)];
+    uint8_t firstIsSummary;
+    uint32_t count;
+    if (!in.read(magic, sizeof(magic)) || std::string(magic, sizeof(magic)) != std::string(spillMagic, sizeof(spillMagic)) ||
+        !readValue(in, firstIsSummary) || !readValue(in, count)) {
+        return false;
+    }
+
+    std::vector<Message> history;
+    history.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+        uint8_t role;
+        int64_t timestamp;
+        uint32_t length;
+        if (!readValue(in, role) || !readValue(in, timestamp) || !readValue(in, length)) {
+            return false;
+        }
+        std::string content(length, '\0');
+        if (!in.read(&content[0], length)) {
+            return false;
+        }
+        history.emplace_back(role == 0 ? Message::Role::USER : Message::Role::ASSISTANT, content);
+        history.back().timestamp = std::chrono::system_clock::time_point(std::chrono::system_clock::duration(timestamp));
+    }
+
+    session.shortTerm->restoreHistory(history, firstIsSummary != 0);
+    in.close();
+    std::remove(path.c_str());
+    return true;
+}
@@ -1,87 +1,381 @@
 #include "ShortTermMemory.hpp"
-#include <sstream>
+#include "JsonWriter.hpp"
+#include <algorithm>
+#include <iostream>
 
 ShortTermMemory::ShortTermMemory(std::shared_ptr<LLMAgent> agent, 
-                                size_t maxSize, size_t threshold, size_t keepRecent)
-    : llmAgent(agent), 
-      maxContextSize(maxSize), 
-      summaryThreshold(threshold),
-      recentMessagesToKeep(keepRecent) {}
+                                size_t maxTokens, size_t thresholdTokens, size_t keepRecent,
+                                std::shared_ptr<TokenCounter> counter,
+                                std::shared_ptr<WorkerPool> pool)
+    : arena(std::make_shared<MessageArena>()),
+      maxContextSize(maxTokens), 
+      summaryThreshold(thresholdTokens),
+      recentMessagesToKeep(keepRecent),
+      llmAgent(agent), 
+      tokenCounter(counter ? counter : std::make_shared<TokenCounter>()),
+      summaryPool(pool ? pool : std::make_shared<WorkerPool>(1)) {}
+
+ShortTermMemory::~ShortTermMemory() {
+    // 대기 중이거나 실행 중인 요약 작업이 this를 더 쓰지 않을 때까지 대기
+    std::unique_lock<std::mutex> lock(historyMutex);
+    stopping = true;
+    summaryFinished.wait(lock, [this] { return !summarizing; });
+}
+
+void ShortTermMemory::appendMessage(Message::Role role, std::string_view content,
+                                    std::chrono::system_clock::time_point timestamp, size_t tokens) {
+    MessageArena::Handle handle = arena->append(role, content, timestamp);
+    conversationHistory.push_back(handle);
+    messageTokens.push_back(tokens);
+    currentTokens += tokens;
+    appendSerialized(arena->view(handle));
+}
+
+void ShortTermMemory::appendSerialized(const MessageView& message) {
+    contextBuffer += message.getRoleString();
+    contextBuffer += ": ";
+    contextBuffer += message.content;
+    contextBuffer += "\n\n";
+    
+    if (!jsonBuffer.empty()) {
+        jsonBuffer += ",";
+    }
+    JsonWriter writer(jsonBuffer);
+    message.writeJSON(writer);
+}
+
+void ShortTermMemory::rebuildSerialized() {
+    contextBuffer.clear();
+    jsonBuffer.clear();
+    for (MessageArena::Handle handle : conversationHistory) {
+        appendSerialized(arena->view(handle));
+    }
+    lastPromptLength = 0;
+    prefixVersion++;
+}
+
+void ShortTermMemory::compactArenaIfNeeded() {
+    // 요약으로 빠진 메시지가 살아 있는 메시지보다 많아지면 살아 있는 것만 새 아레나로 옮김
+    // (이전 아레나는 요약 작업이나 스냅샷이 놓을 때 해제)
+    if (arena->size() < 2 * conversationHistory.size() + 64) {
+        return;
+    }
+    auto compacted = std::make_shared<MessageArena>();
+    for (MessageArena::Handle& handle : conversationHistory) {
+        handle = compacted->append(arena->view(handle));
+    }
+    arena = std::move(compacted);
+}
 
 void ShortTermMemory::addMessage(const Message& message) {
-    conversationHistory.push_back(message);
+    size_t tokens = tokenCounter->count(message.content) + messageOverheadTokens;
+    
+    std::lock_guard<std::mutex> lock(historyMutex);
+    appendMessage(message.role, message.content, message.timestamp, tokens);
     
-    if (getCurrentContextSize() > summaryThreshold) {
-        summarizeOlderMessages();
+    if (currentTokens > summaryThreshold) {
+        scheduleSummaryLocked();
     }
 }
 
-size_t ShortTermMemory::getCurrentContextSize() const {
-    size_t totalSize = 0;
-    for (const auto& msg : conversationHistory) {
-        totalSize += msg.content.size();
+void ShortTermMemory::addMessage(Message::Role role, std::string_view content) {
+    size_t tokens = tokenCounter->count(content) + messageOverheadTokens;
+    auto timestamp = std::chrono::system_clock::now();
+    
+    std::lock_guard<std::mutex> lock(historyMutex);
+    appendMessage(role, content, timestamp, tokens);
+    
+    if (currentTokens > summaryThreshold) {
+        scheduleSummaryLocked();
     }
-    return totalSize;
+}
+
+size_t ShortTermMemory::getCurrentContextSize() const {
+    std::lock_guard<std::mutex> lock(historyMutex);
+    return currentTokens;
 }
 
 void ShortTermMemory::summarizeOlderMessages() {
-    if (conversationHistory.size() <= recentMessagesToKeep) {
+    std::lock_guard<std::mutex> lock(historyMutex);
+    scheduleSummaryLocked();
+}
+
+void ShortTermMemory::scheduleSummaryLocked() {
+    // 이미 요약 중이면 끝난 뒤 다시 확인하므로 중복 요청하지 않음
+    // 맨 앞의 요약 메시지는 요약 계층이 따로 관리하므로 스냅샷에서 제외
+    size_t first = hasSummaryMessage ? 1 : 0;
+    if (summarizing || conversationHistory.size() <= first + recentMessagesToKeep) {
         return;
     }
     
-    std::vector<Message> messagesToSummarize(
-        conversationHistory.begin(), 
-        conversationHistory.end() - recentMessagesToKeep
-    );
-    
-    std::vector<Message> messagesToKeep(
-        conversationHistory.end() - recentMessagesToKeep, 
-        conversationHistory.end()
+    // 내용은 복사하지 않고 뷰만 (아레나 참조를 함께 넘겨 압축되어도 유효)
+    pendingSnapshot.clear();
+    for (size_t i = first; i < conversationHistory.size() - recentMessagesToKeep; i++) {
+        pendingSnapshot.push_back(arena->view(conversationHistory[i]));
+    }
+    pendingArena = arena;
+    pendingGeneration = historyGeneration;
+    pendingSnapshotTokens.assign(
+        messageTokens.begin() + first,
+        messageTokens.end() - recentMessagesToKeep
     );
+    summarizing = true;
+    summaryPool->submit([this] { runSummary(); });
+}
+
+std::string ShortTermMemory::summarizeCached(const std::vector<MessageView>& messages) {
+    // FNV-1a (역할과 내용, 구분자 포함)
+    uint64_t hash = 1469598103934665603ULL;
+    auto mix = [&hash](unsigned char c) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    };
+    for (const auto& msg : messages) {
+        mix(msg.role == Message::Role::USER ? 'u' : 'a');
+        mix(0x1f);
+        for (char c : msg.content) {
+            mix(static_cast<unsigned char>(c));
+        }
+        mix(0x1e);
+    }
     
-    std::string summary = llmAgent->summarizeConversation(messagesToSummarize);
+    auto it = summaryCache.find(hash);
+    if (it != summaryCache.end()) {
+        return it->second;
+    }
     
-    conversationHistory.clear();
-    conversationHistory.push_back(Message(Message::Role::ASSISTANT, 
-                                         "대화 요약: " + summary));
+    std::string summary = llmAgent->summarizeConversation(messages);
+    if (summaryCache.size() >= summaryCacheLimit) {
+        summaryCache.clear();
+    }
+    summaryCache[hash] = summary;
+    return summary;
+}
+
+void ShortTermMemory::addSummary(size_t level, std::string summary) {
+    if (summaryLevels.size() <= level) {
+        summaryLevels.resize(level + 1);
+    }
+    summaryLevels[level].push_back(std::move(summary));
+    if (summaryLevels[level].size() < summaryFanout) {
+        return;
+    }
     
-    for (const auto& msg : messagesToKeep) {
-        conversationHistory.push_back(msg);
+    // 같은 단계 요약이 summaryFanout개 모이면 그것들만 병합해 한 단계 위로
+    std::vector<MessageView> parts;
+    for (const auto& part : summaryLevels[level]) {
+        parts.push_back(MessageView{Message::Role::ASSISTANT, part, std::chrono::system_clock::now()});
     }
+    std::string merged = summarizeCached(parts);
+    summaryLevels[level].clear();
+    addSummary(level + 1, std::move(merged));
 }
 
-std::string ShortTermMemory::getContextForNewQuery(const std::string& newQuery) const {
-    std::stringstream contextStream;
+std::string ShortTermMemory::composeSummary() const {
+    // 오래된(높은 단계) 요약부터 시간 순서로
+    std::string composed = "대화 요약:";
+    for (size_t level = summaryLevels.size(); level-- > 0;) {
+        for (const auto& summary : summaryLevels[level]) {
+            composed += "\n" + summary;
+        }
+    }
+    return composed;
+}
+
+void ShortTermMemory::runSummary() {
+    std::unique_lock<std::mutex> lock(historyMutex);
+    if (stopping) {
+        summarizing = false;
+        summaryFinished.notify_all();
+        return;
+    }
+    
+    std::vector<MessageView> messagesToSummarize;
+    std::vector<size_t> tokensToSummarize;
+    std::shared_ptr<const MessageArena> snapshotArena = std::move(pendingArena);
+    messagesToSummarize.swap(pendingSnapshot);
+    tokensToSummarize.swap(pendingSnapshotTokens);
+    // 스냅샷을 뜬 시점의 세대 (작업이 시작되기 전에 clearHistory가 끼어들 수 있음)
+    uint64_t generation = pendingGeneration;
+    lock.unlock();
+    
+    // LLM 호출과 토큰 계산은 잠금 없이 (그동안 addMessage는 계속 진행)
+    // 실패하면 요약 계층을 되돌리고 기록은 요약하지 않은 채로 둠 (작업자 스레드 밖으로 예외를 내보내지 않음)
+    std::vector<std::vector<std::string>> previousLevels = summaryLevels;
+    uint64_t previousTreeGeneration = summaryTreeGeneration;
+    std::string summaryText;
+    size_t summaryTokens = 0;
+    bool succeeded = true;
+    try {
+        if (summaryTreeGeneration != generation) {
+            // clearHistory 이후 첫 요약: 이전 대화의 요약 계층 폐기
+            summaryLevels.clear();
+            summaryTreeGeneration = generation;
+        }
+        std::vector<MessageView> chunk;
+        size_t chunkTokens = 0;
+        for (size_t i = 0; i < messagesToSummarize.size(); i++) {
+            if (!chunk.empty() && chunkTokens + tokensToSummarize[i] > summaryChunkTokens) {
+                addSummary(0, summarizeCached(chunk));
+                chunk.clear();
+                chunkTokens = 0;
+            }
+            chunk.push_back(messagesToSummarize[i]);
+            chunkTokens += tokensToSummarize[i];
+        }
+        addSummary(0, summarizeCached(chunk));
+        
+        summaryText = composeSummary();
+        summaryTokens = tokenCounter->count(summaryText) + messageOverheadTokens;
+    } catch (const std::exception& e) {
+        std::cerr << "대화 요약 실패: " << e.what() << std::endl;
+        succeeded = false;
+    } catch (...) {
+        std::cerr << "대화 요약 실패: 알 수 없는 오류" << std::endl;
+        succeeded = false;
+    }
+    if (!succeeded) {
+        summaryLevels = std::move(previousLevels);
+        summaryTreeGeneration = previousTreeGeneration;
+        lock.lock();
+        summarizing = false;
+        summaryFinished.notify_all();
+        return;
+    }
+    
+    lock.lock();
+    if (generation == historyGeneration) {
+        // 스냅샷 이후에는 뒤에 추가만 일어나므로 요약 메시지 다음의 n개가 곧 요약한 메시지
+        size_t first = hasSummaryMessage ? 1 : 0;
+        size_t n = messagesToSummarize.size();
+        for (size_t i = 0; i < first + n; i++) {
+            currentTokens -= messageTokens[i];
+        }
+        conversationHistory.erase(conversationHistory.begin(), conversationHistory.begin() + first + n);
+        messageTokens.erase(messageTokens.begin(), messageTokens.begin() + first + n);
+        MessageArena::Handle summaryHandle = arena->append(Message::Role::ASSISTANT, summaryText,
+                                                           std::chrono::system_clock::now());
+        conversationHistory.insert(conversationHistory.begin(), summaryHandle);
+        messageTokens.insert(messageTokens.begin(), summaryTokens);
+        currentTokens += summaryTokens;
+        hasSummaryMessage = true;
+        compactArenaIfNeeded();
+        rebuildSerialized();
+    }
+    summarizing = false;
     
-    for (const auto& msg : conversationHistory) {
-        contextStream << msg.getRoleString() << ": " << msg.content << "\n\n";
+    // 요약하는 동안 쌓인 메시지로 다시 임계값을 넘었으면 이어서 요약
+    if (!stopping && currentTokens > summaryThreshold) {
+        scheduleSummaryLocked();
     }
+    // 알림은 잠금을 쥔 채로 (깨어난 소멸자가 this를 정리해도 이후 접근 없음)
+    summaryFinished.notify_all();
+}
+
+void ShortTermMemory::waitForSummarization() {
+    std::unique_lock<std::mutex> lock(historyMutex);
+    summaryFinished.wait(lock, [this] { return !summarizing; });
+}
+
+bool ShortTermMemory::isSummarizing() const {
+    std::lock_guard<std::mutex> lock(historyMutex);
+    return summarizing;
+}
+
+std::string ShortTermMemory::getContextForNewQuery(const std::string& newQuery) const {
+    std::lock_guard<std::mutex> lock(historyMutex);
     
     // comment not to include the new query twice in the context
     // contextStream << "user: " << newQuery;
     
-    return contextStream.str();
+    lastPromptLength = contextBuffer.size();
+    return contextBuffer;
+}
+
+size_t ShortTermMemory::getPrefixBoundary() const {
+    std::lock_guard<std::mutex> lock(historyMutex);
+    return std::min(lastPromptLength, contextBuffer.size());
+}
+
+uint64_t ShortTermMemory::getPrefixVersion() const {
+    std::lock_guard<std::mutex> lock(historyMutex);
+    return prefixVersion;
 }
 
 std::string ShortTermMemory::getConversationHistoryJSON() const {
-    std::stringstream jsonStream;
-    jsonStream << "[";
-    
-    for (size_t i = 0; i < conversationHistory.size(); ++i) {
-        jsonStream << conversationHistory[i].toJSON();
-        if (i < conversationHistory.size() - 1) {
-            jsonStream << ",";
-        }
-    }
-    
-    jsonStream << "]";
-    return jsonStream.str();
+    std::lock_guard<std::mutex> lock(historyMutex);
+    return "[" + jsonBuffer + "]";
 }
 
 std::vector<Message> ShortTermMemory::getConversationHistory() const {
-    return conversationHistory;
+    std::lock_guard<std::mutex> lock(historyMutex);
+    std::vector<Message> history;
+    history.reserve(conversationHistory.size());
+    for (MessageArena::Handle handle : conversationHistory) {
+        history.push_back(arena->view(handle).toMessage());
+    }
+    return history;
+}
+
+ConversationSnapshot ShortTermMemory::getConversationSnapshot() const {
+    std::lock_guard<std::mutex> lock(historyMutex);
+    ConversationSnapshot snapshot;
+    snapshot.arena = arena;
+    snapshot.messages.reserve(conversationHistory.size());
+    for (MessageArena::Handle handle : conversationHistory) {
+        snapshot.messages.push_back(arena->view(handle));
+    }
+    return snapshot;
 }
 
 void ShortTermMemory::clearHistory() {
+    std::lock_guard<std::mutex> lock(historyMutex);
+    historyGeneration++;
+    hasSummaryMessage = false;
+    conversationHistory.clear();
+    arena = std::make_shared<MessageArena>();
+    messageTokens.clear();
+    currentTokens = 0;
+    rebuildSerialized();
+}
+
+void ShortTermMemory::restoreHistory(const std::vector<Message>& messages, bool firstIsSummary) {
+    std::vector<size_t> tokens;
+    tokens.reserve(messages.size());
+    for (const auto& msg : messages) {
+        tokens.push_back(tokenCounter->count(msg.content) + messageOverheadTokens);
+    }
+    
+    std::unique_lock<std::mutex> lock(historyMutex);
+    summaryFinished.wait(lock, [this] { return !summarizing; });
+    historyGeneration++;
+    arena = std::make_shared<MessageArena>();
     conversationHistory.clear();
+    for (const auto& msg : messages) {
+        conversationHistory.push_back(arena->append(msg.role, msg.content, msg.timestamp));
+    }
+    messageTokens = std::move(tokens);
+    currentTokens = 0;
+    for (size_t t : messageTokens) {
+        currentTokens += t;
+    }
+    hasSummaryMessage = firstIsSummary && !messages.empty();
+    
+    // 요약 계층은 저장하지 않으므로 기존 요약 전체를 0단계 요약 하나로 둠
+    summaryLevels.clear();
+    summaryTreeGeneration = historyGeneration;
+    if (hasSummaryMessage) {
+        const std::string_view prefix = "대화 요약:\n";
+        std::string_view content = messages[0].content;
+        if (content.compare(0, prefix.size(), prefix) == 0) {
+            content.remove_prefix(prefix.size());
+        }
+        summaryLevels.push_back({std::string(content)});
+    }
+    rebuildSerialized();
+}
+
+bool ShortTermMemory::hasSummary() const {
+    std::lock_guard<std::mutex> lock(historyMutex);
+    return hasSummaryMessage;
 }
@@ -0,0 +1,59 @@
+#include "TokenCounter.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+TokenCounter::TokenCounter(const std::string& modelPath) {
+    std::string path = modelPath;
+    if (path.empty()) {
+        const char* env = std::getenv("SENTENCEPIECE_MODEL");
+        path = env ? env : "";
+    }
+    if (path.empty()) {
+        return;
+    }
+    
+#ifdef HAVE_SENTENCEPIECE
+    processor = std::make_unique<sentencepiece::SentencePieceProcessor>();
+    modelLoaded = processor->Load(path).ok();
+    if (!modelLoaded) {
+        std::cerr << "토크나이저 모델을 불러올 수 없어 근사 토큰 수를 사용합니다: " << path << std::endl;
+        processor.reset();
+    }
+#else
+    std::cerr << "sentencepiece 없이 빌드되어 근사 토큰 수를 사용합니다: " << path << std::endl;
+#endif
+}
+
+size_t TokenCounter::count(std::string_view text) const {
+#ifdef HAVE_SENTENCEPIECE
+    if (modelLoaded) {
+        std::vector<int> ids;
+        if (processor->Encode({text.data(), text.size()}, &ids).ok()) {
+            return ids.size();
+        }
+    }
+#endif
+    return approximateCount(text);
+}
+
+size_t TokenCounter::approximateCount(std::string_view text) {
+    size_t tokens = 0;
+    size_t asciiRun = 0;
+    for (size_t i = 0; i < text.size(); i++) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c < 0x80) {
+            if (c == ' ' || c == '\n' || c == '\t') {
+                tokens += (asciiRun + 3) / 4;
+                asciiRun = 0;
+            } else {
+                asciiRun++;
+            }
+        } else if ((c & 0xC0) != 0x80) {
+            // UTF-8 문자의 첫 바이트 (한글 음절 하나가 대체로 1토큰 이상)
+            tokens += (asciiRun + 3) / 4 + 1;
+            asciiRun = 0;
+        }
+    }
+    return tokens + (asciiRun + 3) / 4;
+}
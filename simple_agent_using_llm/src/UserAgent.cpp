@@ -1,7 +1,9 @@
 #include "UserAgent.hpp"
 #include <iostream>
 
-UserAgent::UserAgent() {
+UserAgent::UserAgent()
+    : retrievalTimeout(std::chrono::milliseconds(300)),
+      retrievalPool(std::make_unique<WorkerPool>(1)) {
     // 벡터 DB 및 LLM Agent 인스턴스 생성
     auto vectorDB = std::make_shared<SimpleVectorDB>();
     
@@ -25,34 +27,23 @@ bool UserAgent::switchAgent(const std::string& agentId) {
     return false;
 }
 
+UserAgent::~UserAgent() {
+    // 늦게 끝나는 검색이 memoryManager를 쓰고 있을 수 있으므로 다른 멤버보다 먼저 작업자를 정리
+    retrievalPool.reset();
+}
+
+void UserAgent::setRetrievalTimeout(std::chrono::milliseconds timeout) {
+    retrievalTimeout = timeout;
+}
+
 std::string UserAgent::processQuery(const std::string& query) {
-    // 사용자 메시지 저장
-    memoryManager->addUserMessage(query);
-    
-    // 관련 컨텍스트 준비
-    std::string prompt = memoryManager->preparePromptForNewQuery(query);
+    // 턴 처리는 SessionManager와 같은 MemoryManager::processTurn 사용 (현재 에이전트로 응답 생성)
+    MemoryManager::TurnResult turn = memoryManager->processTurn(*llmAgents[currentAgentId], query,
+                                                                *retrievalPool, retrievalTimeout);
 
-    std::cout << "[프롬프트--시작]" << std::endl << prompt << std::endl << "[프롬프트--끝]" << std::endl;
-    
-    // 장기 기억에서 관련 대화 검색 (필요시)
-    std::vector<std::string> relevantConversations;
-    if (query.length() > 0) { // 간단한 예시 조건
-        relevantConversations = memoryManager->retrieveRelevantConversations(query);
-        
-        // 관련 대화가 있으면 프롬프트에 추가
-        if (!relevantConversations.empty()) {
-            prompt = "다음은 이전에 유사한 주제로 나눈 대화입니다:\n\n" + 
-                     relevantConversations[0] + "\n\n현재 대화:\n\n" + prompt;
-        }
-    }
-    
-    // 현재 에이전트로 응답 생성
-    std::string response = llmAgents[currentAgentId]->generateResponse(prompt);
-    
-    // 응답 저장
-    memoryManager->addAssistantResponse(response);
+    std::cout << "[프롬프트--시작]" << std::endl << turn.prompt << std::endl << "[프롬프트--끝]" << std::endl;
     
-    return response;
+    return turn.response;
 }
 
 void UserAgent::startNewSession() {
@@ -1,65 +1,413 @@
 #include "VectorDB.hpp"
 #include <algorithm>
 #include <cmath>
+#include <queue>
+#include <functional>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
 
-float SimpleVectorDB::cosineSimilarity(const std::vector<float>& vec1, const std::vector<float>& vec2) {
-    float dotProduct = 0.0f;
-    float norm1 = 0.0f;
-    float norm2 = 0.0f;
-    
-    for (size_t i = 0; i < vec1.size() && i < vec2.size(); i++) {
-        dotProduct += vec1[i] * vec2[i];
-        norm1 += vec1[i] * vec1[i];
-        norm2 += vec2[i] * vec2[i];
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define VECTOR_DB_X86 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+float dotProductScalar(const float* a, const float* b, size_t n) {
+    float sum = 0.0f;
+    for (size_t i = 0; i < n; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+#ifdef VECTOR_DB_X86
+// -march 옵션 없이도 AVX2/FMA 경로를 빌드하고, 실행 시 CPU가 지원할 때만 사용
+__attribute__((target("avx2,fma")))
+float dotProductAvx2(const float* a, const float* b, size_t n) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+    }
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+    }
+    __m256 acc = _mm256_add_ps(acc0, acc1);
+    __m128 sum4 = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    sum4 = _mm_add_ps(sum4, _mm_movehl_ps(sum4, sum4));
+    sum4 = _mm_add_ss(sum4, _mm_shuffle_ps(sum4, sum4, 1));
+    float sum = _mm_cvtss_f32(sum4);
+    for (; i < n; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+const bool hasAvx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+
+const char logMagic[8] = {'S', 'V', 'D', 'B', 'L', 'O', 'G', '1'};
+const size_t compactMinRecords = 1024;
+
+uint32_t crc32(const char* data, size_t length) {
+    static const std::vector<uint32_t> table = [] {
+        std::vector<uint32_t> t(256);
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < length; i++) {
+        crc = table[(crc ^ static_cast<unsigned char>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+void putU32(std::string& out, uint32_t value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+bool getU32(const std::string& in, size_t& pos, size_t end, uint32_t& value) {
+    if (pos + sizeof(value) > end) return false;
+    std::memcpy(&value, in.data() + pos, sizeof(value));
+    pos += sizeof(value);
+    return true;
+}
+
+// offset 위치부터 기록 (실패 후 재시도하면 같은 위치를 덮어쓰므로 일부만 기록된 레코드가 남지 않음)
+bool writeAll(int fd, const std::string& data, off_t offset) {
+    size_t written = 0;
+    while (written < data.size()) {
+        ssize_t n = ::pwrite(fd, data.data() + written, data.size() - written, offset + static_cast<off_t>(written));
+        if (n < 0) return false;
+        written += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// 로그 파일을 새 내용으로 원자적으로 교체 (임시 파일 기록 -> fsync -> rename -> 디렉토리 fsync)
+bool replaceFile(const std::string& path, const std::string& image) {
+    std::string tmpPath = path + ".tmp";
+    int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    bool ok = writeAll(fd, image, 0) && ::fsync(fd) == 0;
+    ::close(fd);
+    if (!ok || ::rename(tmpPath.c_str(), path.c_str()) != 0) return false;
+
+    size_t slash = path.find_last_of('/');
+    std::string dir = slash == std::string::npos ? "." : path.substr(0, slash + 1);
+    int dirFd = ::open(dir.c_str(), O_RDONLY);
+    if (dirFd >= 0) {
+        ::fsync(dirFd);
+        ::close(dirFd);
+    }
+    return true;
+}
+
+} // namespace
+
+float SimpleVectorDB::dotProduct(const float* a, const float* b, size_t n) {
+#if defined(VECTOR_DB_X86)
+    if (hasAvx2) return dotProductAvx2(a, b, n);
+#elif defined(__ARM_NEON)
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc = vmlaq_f32(acc, vld1q_f32(a + i), vld1q_f32(b + i));
+    }
+    float lanes[4];
+    vst1q_f32(lanes, acc);
+    float sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    for (; i < n; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+#endif
+    return dotProductScalar(a, b, n);
+}
+
+void SimpleVectorDB::normalizeInto(const std::vector<float>& embedding, float* out) const {
+    std::copy(embedding.begin(), embedding.end(), out);
+
+    float norm = std::sqrt(dotProductScalar(out, out, dimension));
+    if (norm == 0.0f) return; // 영벡터는 모든 항목과 유사도 0
+    for (size_t i = 0; i < dimension; i++) {
+        out[i] /= norm;
+    }
+}
+
+SimpleVectorDB::SimpleVectorDB(const std::string& path, std::chrono::milliseconds commitInterval)
+    : logPath(path), commitInterval(commitInterval) {
+    loadFromDisk();
+    committer = std::thread(&SimpleVectorDB::commitLoop, this);
+}
+
+SimpleVectorDB::~SimpleVectorDB() {
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+        stopping = true;
+    }
+    flushRequested.notify_one();
+    committer.join();
+    if (logFd >= 0) {
+        ::close(logFd);
+    }
+}
+
+size_t SimpleVectorDB::upsertRow(const std::string& id, const std::string& meta) {
+    auto it = rowIndex.find(id);
+    if (it != rowIndex.end()) {
+        // 같은 ID는 기존 행을 덮어씀
+        metadata[it->second] = meta;
+        return it->second;
     }
-    
-    if (norm1 == 0.0f || norm2 == 0.0f) return 0.0f;
-    
-    return dotProduct / (std::sqrt(norm1) * std::sqrt(norm2));
+    size_t row = ids.size();
+    rowIndex[id] = row;
+    ids.push_back(id);
+    metadata.push_back(meta);
+    matrix.resize(matrix.size() + dimension);
+    return row;
 }
 
-void SimpleVectorDB::store(const std::string& id, const std::vector<float>& embedding, 
+void SimpleVectorDB::appendRecord(std::string& out, size_t row) const {
+    std::string payload;
+    putU32(payload, static_cast<uint32_t>(ids[row].size()));
+    payload += ids[row];
+    putU32(payload, static_cast<uint32_t>(dimension));
+    payload.append(reinterpret_cast<const char*>(matrix.data() + row * dimension), dimension * sizeof(float));
+    putU32(payload, static_cast<uint32_t>(metadata[row].size()));
+    payload += metadata[row];
+
+    putU32(out, static_cast<uint32_t>(payload.size()));
+    putU32(out, crc32(payload.data(), payload.size()));
+    out += payload;
+}
+
+void SimpleVectorDB::store(const std::string& id, const std::vector<float>& embedding,
                           const std::string& metadata) {
-    database[id] = {embedding, metadata};
-    persistToDisk();
+    // 빈 임베딩이나 차원이 다른 임베딩은 행렬 배치를 깨뜨리므로 저장하지 않음
+    if (embedding.empty() || (dimension != 0 && embedding.size() != dimension)) {
+        std::cerr << "벡터 DB 저장 거부: 임베딩 차원 " << embedding.size()
+                  << " (데이터베이스 차원 " << dimension << "), ID " << id << std::endl;
+        return;
+    }
+    if (dimension == 0) {
+        dimension = embedding.size();
+    }
+
+    size_t row = upsertRow(id, metadata);
+    normalizeInto(embedding, matrix.data() + row * dimension);
+
+    std::lock_guard<std::mutex> lock(logMutex);
+    appendedSeq++;
+    if (logRecords >= compactMinRecords && logRecords >= 2 * ids.size()) {
+        // 죽은 레코드가 절반 이상: 아직 쓰지 않은 레코드까지 포함한 현재 내용으로 로그 교체
+        compactImage.assign(logMagic, sizeof(logMagic));
+        for (size_t i = 0; i < ids.size(); i++) {
+            appendRecord(compactImage, i);
+        }
+        pending.clear();
+        logRecords = ids.size();
+    } else {
+        appendRecord(pending, row);
+        logRecords++;
+    }
 }
 
 std::vector<std::pair<std::string, float>> SimpleVectorDB::search(
     const std::vector<float>& queryEmbedding, int topK) {
-    
+
     std::vector<std::pair<std::string, float>> results;
-    
-    for (const auto& entry : database) {
-        float similarity = cosineSimilarity(queryEmbedding, entry.second.embedding);
-        results.push_back({entry.second.metadata, similarity});
-    }
-    
-    std::sort(results.begin(), results.end(), 
-             [](const auto& a, const auto& b) { return a.second > b.second; });
-    
-    if (results.size() > static_cast<size_t>(topK)) {
-        results.resize(topK);
-    }
-    
+    if (topK <= 0 || ids.empty()) return results;
+    if (queryEmbedding.size() != dimension) {
+        std::cerr << "벡터 DB 검색 거부: 쿼리 차원 " << queryEmbedding.size()
+                  << " (데이터베이스 차원 " << dimension << ")" << std::endl;
+        return results;
+    }
+
+    // 쿼리는 한 번만 정규화하므로 행마다 내적이 곧 코사인 유사도
+    std::vector<float> query(dimension);
+    normalizeInto(queryEmbedding, query.data());
+
+    // (점수, 행) 최소 힙으로 상위 topK개만 유지
+    using Candidate = std::pair<float, size_t>;
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> heap;
+    size_t k = std::min(static_cast<size_t>(topK), ids.size());
+    const float* row = matrix.data();
+    for (size_t i = 0; i < ids.size(); i++, row += dimension) {
+        float score = dotProduct(query.data(), row, dimension);
+        if (heap.size() < k) {
+            heap.emplace(score, i);
+        } else if (score > heap.top().first) {
+            heap.pop();
+            heap.emplace(score, i);
+        }
+    }
+
+    // 힙에서 꺼낸 순서(오름차순)를 뒤집어 유사도 내림차순으로 반환하고, 메타데이터는 이때만 복사
+    results.resize(heap.size());
+    for (size_t i = heap.size(); i-- > 0; heap.pop()) {
+        results[i] = {metadata[heap.top().second], heap.top().first};
+    }
+
     return results;
 }
 
-void SimpleVectorDB::persistToDisk() {
-    std::ofstream file("vector_db.data");
-    // 실제 저장 로직은 별도로 구현 필요
-    if (file.is_open()) {
-        for (const auto& entry : database) {
-            // 간단한 형식으로만 저장
-            file << entry.first << "\n";
-            // 실제 구현에서는 임베딩과 메타데이터도 저장해야 함
+void SimpleVectorDB::commitLoop() {
+    std::unique_lock<std::mutex> lock(logMutex);
+    while (true) {
+        flushRequested.wait_for(lock, commitInterval, [this] {
+            return stopping || (durableSeq < appendedSeq && flushWaiters > 0);
+        });
+        if (pending.empty() && compactImage.empty()) {
+            durableSeq = appendedSeq;
+            flushed.notify_all();
+            if (stopping) break;
+            continue;
+        }
+
+        // 모인 레코드를 가져가 잠금 없이 기록 (그동안 store는 새 버퍼에 계속 추가)
+        std::string image;
+        std::string batch;
+        image.swap(compactImage);
+        batch.swap(pending);
+        uint64_t seq = appendedSeq;
+        lock.unlock();
+
+        bool imageOk = true;
+        if (!image.empty()) {
+            imageOk = replaceFile(logPath, image);
+            if (imageOk) {
+                logSize = image.size();
+                ::close(logFd);
+                logFd = -1;
+            }
+        }
+        if (imageOk && logFd < 0) {
+            logFd = ::open(logPath.c_str(), O_WRONLY);
+            imageOk = logFd >= 0;
+        }
+        bool batchOk = imageOk;
+        if (batchOk && !batch.empty()) {
+            // 마지막으로 성공한 기록 끝에서부터 씀
+            batchOk = writeAll(logFd, batch, static_cast<off_t>(logSize)) && ::fdatasync(logFd) == 0;
+            if (batchOk) {
+                logSize += batch.size();
+            }
+        }
+
+        lock.lock();
+        if (batchOk) {
+            durableSeq = seq;
+        } else {
+            std::cerr << "벡터 DB 로그 기록 실패, 다음 주기에 다시 시도합니다: " << logPath << std::endl;
+            // 기록하지 못한 내용을 되돌려 둠 (그사이 압축이 일어났다면 새 이미지가 모든 항목을 포함)
+            if (compactImage.empty()) {
+                if (!imageOk) {
+                    compactImage.swap(image);
+                }
+                pending.insert(0, batch);
+            }
+            failedSeq = seq;
+            failedAttempts++;
+        }
+        flushed.notify_all();
+        if (!batchOk && stopping) {
+            std::cerr << "벡터 DB 종료 중 기록하지 못한 내용을 버립니다: " << logPath << std::endl;
+            break;
         }
     }
 }
 
+bool SimpleVectorDB::persistToDisk() {
+    std::unique_lock<std::mutex> lock(logMutex);
+    uint64_t target = appendedSeq;
+    uint64_t attempts = failedAttempts;
+    flushWaiters++;
+    flushRequested.notify_one();
+    // 기다리는 동안 시작된 기록이 이 순번까지 포함한 채 실패하면 실패로 반환
+    flushed.wait(lock, [&] {
+        return durableSeq >= target || (failedAttempts != attempts && failedSeq >= target);
+    });
+    flushWaiters--;
+    return durableSeq >= target;
+}
+
 void SimpleVectorDB::loadFromDisk() {
-    std::ifstream file("vector_db.data");
-    // 실제 로드 로직은 별도로 구현 필요
-    if (file.is_open()) {
-        // 데이터 로드 로직
+    std::string data;
+    {
+        std::ifstream file(logPath, std::ios::binary);
+        if (file.is_open()) {
+            data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        }
+    }
+
+    if (logFd >= 0) {
+        ::close(logFd);
+    }
+    logRecords = 0;
+
+    if (data.size() < sizeof(logMagic) || std::memcmp(data.data(), logMagic, sizeof(logMagic)) != 0) {
+        // 파일이 없거나 로그 형식이 아님 (이전 형식은 ID만 있어 복원할 내용이 없음): 새 로그로 시작
+        replaceFile(logPath, std::string(logMagic, sizeof(logMagic)));
+        logFd = ::open(logPath.c_str(), O_WRONLY);
+        logSize = sizeof(logMagic);
+        return;
+    }
+
+    // 레코드를 차례로 검증하며 재생, 잘렸거나 checksum이 맞지 않는 레코드에서 중단
+    size_t pos = sizeof(logMagic);
+    std::vector<float> embedding;
+    while (true) {
+        size_t cursor = pos;
+        uint32_t length, crc;
+        if (!getU32(data, cursor, data.size(), length) || !getU32(data, cursor, data.size(), crc)) break;
+        if (cursor + length > data.size() || crc32(data.data() + cursor, length) != crc) break;
+
+        size_t end = cursor + length;
+        uint32_t idLength, dim, metaLength;
+        if (!getU32(data, cursor, end, idLength) || cursor + idLength > end) break;
+        std::string id = data.substr(cursor, idLength);
+        cursor += idLength;
+        if (!getU32(data, cursor, end, dim) || cursor + dim * sizeof(float) > end) break;
+        embedding.resize(dim);
+        std::memcpy(embedding.data(), data.data() + cursor, dim * sizeof(float));
+        cursor += dim * sizeof(float);
+        if (!getU32(data, cursor, end, metaLength) || cursor + metaLength > end) break;
+        std::string meta = data.substr(cursor, metaLength);
+        pos = end;
+        logRecords++;
+
+        // 차원이 맞지 않는 레코드는 건너뜀 (checksum은 맞으므로 뒤의 레코드는 계속 재생)
+        if (dim == 0 || (dimension != 0 && dim != dimension)) {
+            continue;
+        }
+        if (dimension == 0) {
+            dimension = dim;
+        }
+        size_t row = upsertRow(id, meta);
+        normalizeInto(embedding, matrix.data() + row * dimension);
+    }
+
+    logFd = ::open(logPath.c_str(), O_WRONLY);
+    logSize = pos;
+    if (pos < data.size()) {
+        // 마지막 기록 중 장애로 남은 불완전한 꼬리 제거 (이후 레코드가 그 뒤에 붙지 않도록)
+        std::cerr << "벡터 DB 로그의 손상된 꼬리를 잘라냅니다: " << (data.size() - pos) << " bytes" << std::endl;
+        if (::ftruncate(logFd, static_cast<off_t>(pos)) != 0 || ::fsync(logFd) != 0) {
+            std::cerr << "벡터 DB 로그 정리 실패: " << logPath << std::endl;
+        }
     }
 }
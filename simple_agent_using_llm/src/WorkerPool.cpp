@@ -0,0 +1,57 @@
+#include "WorkerPool.hpp"
+#include <algorithm>
+#include <iostream>
+
+WorkerPool::WorkerPool(size_t threadCount) {
+    threadCount = std::max<size_t>(1, threadCount);
+    for (size_t i = 0; i < threadCount; i++) {
+        workers.emplace_back(&WorkerPool::workerLoop, this);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    taskAvailable.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void WorkerPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        tasks.push_back(std::move(task));
+    }
+    taskAvailable.notify_one();
+}
+
+size_t WorkerPool::queueDepth() {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return tasks.size();
+}
+
+void WorkerPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            taskAvailable.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (tasks.empty()) {
+                return; // stopping이고 남은 작업 없음
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        // 작업 하나의 예외가 스레드를 끝내면 프로세스 전체가 종료되므로 여기서 기록만 하고 계속
+        try {
+            task();
+        } catch (const std::exception& e) {
+            std::cerr << "작업자 풀 작업 실패: " << e.what() << std::endl;
+        } catch (...) {
+            std::cerr << "작업자 풀 작업 실패: 알 수 없는 오류" << std::endl;
+        }
+    }
+}
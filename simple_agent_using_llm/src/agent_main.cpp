@@ -1,7 +1,43 @@
 #include "UserAgent.hpp"
+#include "SessionManager.hpp"
 #include <iostream>
+#include <mutex>
+
+// 다중 세션 모드: 한 줄에 "세션ID<TAB>질문" (질문이 /end면 세션 저장 후 종료)
+// 응답은 준비되는 대로 "세션ID<TAB>응답" 형식으로 출력
+int runServer() {
+    // 출력 잠금은 세션 관리자보다 먼저 선언 (관리자 소멸 시 끝나는 턴의 콜백이 사용)
+    std::mutex outputMutex;
+    auto vectorDB = std::make_shared<SimpleVectorDB>();
+    SessionManager sessions(std::make_shared<ChatGPTAgent>(), vectorDB);
+    
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        size_t tab = line.find('\t');
+        if (tab == std::string::npos) {
+            continue;
+        }
+        std::string sessionId = line.substr(0, tab);
+        std::string query = line.substr(tab + 1);
+        
+        if (query == "/end") {
+            sessions.endSession(sessionId);
+            continue;
+        }
+        sessions.submit(sessionId, query, [&outputMutex](const std::string& id, const std::string& response) {
+            std::lock_guard<std::mutex> lock(outputMutex);
+            std::cout << id << "\t" << response << std::endl;
+        });
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--serve") {
+        return runServer();
+    }
+    
 
-int main() {
     // UserAgent 생성
     UserAgent agent;
     
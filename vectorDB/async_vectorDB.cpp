@@ -0,0 +1,115 @@
+// VectorDB 클래스에 추가할 필드와 메서드 (threadpool.cpp, request_coalescer.cpp 필요)
+private:
+    struct SearchRequest {
+        std::string query;
+        int k;
+        SimilarityType sim_type;
+    };
+
+    struct AddRequest {
+        std::string text;
+        std::string metadata;
+    };
+
+    using SearchResult = std::vector<std::pair<std::string, float>>;
+
+    std::unique_ptr<RequestCoalescer<SearchRequest, SearchResult>> search_coalescer;
+    std::unique_ptr<RequestCoalescer<AddRequest, size_t>> add_coalescer;
+    bool async_hooks_registered = false;
+
+    // 모인 검색 요청을 한 번에 임베딩한 뒤 검색
+    std::vector<SearchResult> run_search_batch(const std::vector<SearchRequest>& requests) {
+        std::vector<std::string> texts;
+        texts.reserve(requests.size());
+        for (const auto& request : requests) {
+            texts.push_back(request.query);
+        }
+        std::vector<std::vector<float>> embeddings = embed_texts(texts);
+
+        std::vector<SearchResult> results(requests.size());
+
+        #pragma omp parallel for
+        for (size_t i = 0; i < requests.size(); i++) {
+            results[i] = search_by_embedding(embeddings[i], requests[i].k, requests[i].sim_type);
+        }
+
+        return results;
+    }
+
+    // 모인 추가 요청을 한 번에 임베딩한 뒤 인덱스에 추가, 할당된 ID 반환
+    std::vector<size_t> run_add_batch(const std::vector<AddRequest>& requests) {
+        std::vector<std::string> texts;
+        texts.reserve(requests.size());
+        for (const auto& request : requests) {
+            texts.push_back(request.text);
+        }
+        std::vector<std::vector<float>> embeddings = embed_texts(texts);
+
+        std::vector<size_t> ids(requests.size());
+        for (size_t i = 0; i < requests.size(); i++) {
+            ids[i] = append_entry(requests[i].text, requests[i].metadata, embeddings[i]);
+        }
+
+        return ids;
+    }
+
+public:
+    // 비동기 API 활성화
+    // window 안에 들어온 단건 요청들을 최대 max_batch개까지 묶어 pool에서 한 번에 처리합니다.
+    // pool은 이 VectorDB보다 오래 살아야 합니다.
+    void enable_async(ThreadPool& pool,
+                      std::chrono::microseconds window = std::chrono::microseconds(2000),
+                      size_t max_batch = 32) {
+        search_coalescer.reset(new RequestCoalescer<SearchRequest, SearchResult>(
+            pool,
+            [this](const std::vector<SearchRequest>& requests) { return run_search_batch(requests); },
+            window, max_batch));
+
+        add_coalescer.reset(new RequestCoalescer<AddRequest, size_t>(
+            pool,
+            [this](const std::vector<AddRequest>& requests) { return run_add_batch(requests); },
+            window, max_batch));
+
+        if (!async_hooks_registered) {
+            async_hooks_registered = true;
+
+            // 처리 중인 배치가 인덱스와 토크나이저를 쓰므로 해제 전에 병합기부터 정리
+            shutdown_hooks.push_back([this]() {
+                search_coalescer.reset();
+                add_coalescer.reset();
+            });
+
+            // 배치로 보내지 않고 대기 중인 요청 수
+            metrics.add_gauge("search_queue_depth", [this]() {
+                return search_coalescer ? static_cast<double>(search_coalescer->queue_depth()) : 0.0;
+            });
+            metrics.add_gauge("add_queue_depth", [this]() {
+                return add_coalescer ? static_cast<double>(add_coalescer->queue_depth()) : 0.0;
+            });
+        }
+    }
+
+    // 비동기 검색
+    std::future<SearchResult> search_async(const std::string& query, int k = 5,
+                                           SimilarityType sim_type = COSINE) {
+        if (!search_coalescer) {
+            throw std::runtime_error("비동기 API가 활성화되지 않았습니다. enable_async를 먼저 호출하세요.");
+        }
+        return search_coalescer->submit(SearchRequest{query, k, sim_type});
+    }
+
+    // 비동기 추가 (할당된 ID를 반환)
+    std::future<size_t> add_async(const std::string& text, const std::string& metadata = "") {
+        if (!add_coalescer) {
+            throw std::runtime_error("비동기 API가 활성화되지 않았습니다. enable_async를 먼저 호출하세요.");
+        }
+        return add_coalescer->submit(AddRequest{text, metadata});
+    }
+
+    // 아직 배치로 묶이지 않은 요청 수
+    size_t async_queue_depth() {
+        size_t depth = 0;
+        if (search_coalescer) depth += search_coalescer->queue_depth();
+        if (add_coalescer) depth += add_coalescer->queue_depth();
+        return depth;
+    }
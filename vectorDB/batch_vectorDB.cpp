@@ -11,29 +11,13 @@ public:
             throw std::runtime_error("최대 저장 용량을 초과합니다.");
         }
         
-        std::cout << texts.size() << "개의 텍스트를 배치로 추가합니다..." << std::endl;
-        
         // 먼저 모든 임베딩을 계산
-        std::vector<std::vector<float>> embeddings(texts.size());
-        
-        #pragma omp parallel for
-        for (size_t i = 0; i < texts.size(); i++) {
-            embeddings[i] = embed_text(texts[i]);
-        }
+        std::vector<std::vector<float>> embeddings = embed_texts(texts);
         
         // 인덱스에 추가
         for (size_t i = 0; i < texts.size(); i++) {
-            index->addPoint(embeddings[i].data(), start_id + i);
-            stored_texts.push_back(texts[i]);
-            
-            if (metadatas.empty()) {
-                stored_metadata.push_back("");
-            } else {
-                stored_metadata.push_back(metadatas[i]);
-            }
+            append_entry(texts[i], metadatas.empty() ? "" : metadatas[i], embeddings[i]);
         }
-        
-        std::cout << "배치 추가 완료. 현재 저장된 항목 수: " << stored_texts.size() << std::endl;
     }
     
     // 대량의 쿼리를 한번에 처리
@@ -45,8 +29,6 @@ public:
         std::vector<std::vector<std::pair<std::string, float>>> all_results;
         all_results.reserve(queries.size());
         
-        std::cout << queries.size() << "개의 쿼리를 배치로 처리합니다..." << std::endl;
-        
         #pragma omp parallel for
         for (size_t i = 0; i < queries.size(); i++) {
             std::vector<std::pair<std::string, float>> results = search(queries[i], k, sim_type);
@@ -57,6 +39,5 @@ public:
             }
         }
         
-        std::cout << "배치 검색 완료." << std::endl;
         return all_results;
     }
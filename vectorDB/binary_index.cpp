@@ -0,0 +1,218 @@
+#include <vector>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <memory>
+#include <hnswlib/hnswlib.h>
+
+#if defined(__AVX512VPOPCNTDQ__) || defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// 부호 이진 양자화 인덱스
+// 차원마다 1비트(부호)만 저장해 float 벡터보다 32배 작은 코드를 해밍 거리로 전수 검색하고,
+// 상위 후보만 int8 코드(차원마다 1바이트 + 벡터별 스케일)로 다시 채점합니다.
+// ID는 0부터 연속이어야 하며, add로 기록한 뒤 publish로 검색 범위에 포함시킵니다.
+class BinaryIndex {
+public:
+    BinaryIndex(size_t dim, size_t max_elements, bool keep_int8 = true)
+        : dimension(dim), words((dim + 63) / 64), capacity(max_elements), count(0) {
+        codes.reset(new uint64_t[capacity * words]());
+        if (keep_int8) {
+            int8_codes.reset(new int8_t[capacity * dimension]());
+            int8_scales.reset(new float[capacity]());
+        }
+    }
+
+    // 벡터 부호화 (검색 범위에는 publish 후 포함)
+    void add(size_t id, const float* vec) {
+        encode(vec, code_at(id));
+        if (int8_codes) {
+            float max_abs = 0.0f;
+            for (size_t j = 0; j < dimension; j++) max_abs = std::max(max_abs, std::fabs(vec[j]));
+            float scale = max_abs > 0.0f ? max_abs / 127.0f : 1.0f;
+            int8_t* q = int8_codes.get() + id * dimension;
+            for (size_t j = 0; j < dimension; j++) {
+                q[j] = static_cast<int8_t>(std::lround(vec[j] / scale));
+            }
+            int8_scales[id] = scale;
+        }
+    }
+
+    // [0, n) 범위의 항목을 검색 대상으로 공개
+    void publish(size_t n) {
+        count.store(n, std::memory_order_release);
+    }
+
+    size_t size() const {
+        return count.load(std::memory_order_acquire);
+    }
+
+    size_t code_words() const {
+        return words;
+    }
+
+    bool has_int8() const {
+        return static_cast<bool>(int8_codes);
+    }
+
+    uint64_t* code_at(size_t id) {
+        return codes.get() + id * words;
+    }
+
+    const uint64_t* code_at(size_t id) const {
+        return codes.get() + id * words;
+    }
+
+    // 부호 비트 코드 (양수면 1)
+    void encode(const float* vec, uint64_t* code) const {
+        std::memset(code, 0, words * sizeof(uint64_t));
+        for (size_t j = 0; j < dimension; j++) {
+            if (vec[j] > 0.0f) {
+                code[j / 64] |= 1ULL << (j % 64);
+            }
+        }
+    }
+
+    static uint32_t hamming(const uint64_t* a, const uint64_t* b, size_t words) {
+        size_t i = 0;
+        uint32_t distance = 0;
+#if defined(__AVX512VPOPCNTDQ__) && defined(__AVX512F__)
+        __m512i acc = _mm512_setzero_si512();
+        for (; i + 8 <= words; i += 8) {
+            __m512i x = _mm512_xor_si512(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i));
+            acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(x));
+        }
+        distance = static_cast<uint32_t>(_mm512_reduce_add_epi64(acc));
+#elif defined(__ARM_NEON)
+        uint16x8_t acc = vdupq_n_u16(0);
+        for (; i + 2 <= words; i += 2) {
+            uint8x16_t x = veorq_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(a + i)),
+                                    vld1q_u8(reinterpret_cast<const uint8_t*>(b + i)));
+            acc = vpadalq_u8(acc, vcntq_u8(x));
+        }
+        distance = vaddvq_u16(acc);
+#endif
+        for (; i < words; i++) {
+            distance += static_cast<uint32_t>(__builtin_popcountll(a[i] ^ b[i])); // -mpopcnt에서 POPCNT 명령
+        }
+        return distance;
+    }
+
+    // 해밍 거리가 가장 작은 후보 ID (최대 limit개)
+    // 거리 범위가 [0, dim]이므로 정렬 대신 거리 히스토그램으로 경계 거리를 찾아 두 번 순회로 선택
+    std::vector<size_t> candidates(const float* query, size_t limit) const {
+        size_t n = size();
+        std::vector<uint64_t> query_code(words);
+        encode(query, query_code.data());
+
+        std::vector<uint16_t> distances(n);
+        std::vector<uint32_t> histogram(dimension + 1, 0);
+        for (size_t id = 0; id < n; id++) {
+            uint16_t d = static_cast<uint16_t>(hamming(query_code.data(), code_at(id), words));
+            distances[id] = d;
+            histogram[d]++;
+        }
+
+        size_t cutoff = 0;
+        size_t below = 0;
+        while (cutoff < histogram.size() && below + histogram[cutoff] < limit) {
+            below += histogram[cutoff];
+            cutoff++;
+        }
+
+        // cutoff보다 가까운 항목은 모두, cutoff 거리인 항목은 limit까지
+        std::vector<size_t> result;
+        result.reserve(std::min(limit, n));
+        size_t at_cutoff = limit > below ? limit - below : 0;
+        for (size_t id = 0; id < n; id++) {
+            if (distances[id] < cutoff) {
+                result.push_back(id);
+            } else if (distances[id] == cutoff && at_cutoff > 0) {
+                result.push_back(id);
+                at_cutoff--;
+            }
+        }
+        return result;
+    }
+
+    // int8 코드로 근사한 내적
+    float int8_dot(const float* query, size_t id) const {
+        const int8_t* q = int8_codes.get() + id * dimension;
+        float sum = 0.0f;
+        for (size_t j = 0; j < dimension; j++) {
+            sum += query[j] * q[j];
+        }
+        return sum * int8_scales[id];
+    }
+
+    // 단독 flat 검색: 해밍 후보 candidate_count개를 int8 내적으로 재채점해 상위 k개 (내적, ID) 반환
+    // (int8 코드가 없으면 해밍 거리가 작은 순서, 점수는 -해밍 거리)
+    std::vector<std::pair<float, size_t>> search(const float* query, size_t k, size_t candidate_count) const {
+        std::vector<size_t> ids = candidates(query, std::max(k, candidate_count));
+        std::vector<uint64_t> query_code(words);
+        encode(query, query_code.data());
+
+        std::vector<std::pair<float, size_t>> scored;
+        scored.reserve(ids.size());
+        for (size_t id : ids) {
+            float score = int8_codes ? int8_dot(query, id)
+                                     : -static_cast<float>(hamming(query_code.data(), code_at(id), words));
+            scored.emplace_back(score, id);
+        }
+
+        size_t top = std::min(k, scored.size());
+        std::partial_sort(scored.begin(), scored.begin() + top, scored.end(),
+                          [](const std::pair<float, size_t>& a, const std::pair<float, size_t>& b) {
+                              return a.first > b.first;
+                          });
+        scored.resize(top);
+        return scored;
+    }
+
+    size_t memory_bytes() const {
+        size_t bytes = capacity * words * sizeof(uint64_t);
+        if (int8_codes) bytes += capacity * (dimension + sizeof(float));
+        return bytes;
+    }
+
+private:
+    size_t dimension;
+    size_t words;
+    size_t capacity;
+    std::atomic<size_t> count;
+    std::unique_ptr<uint64_t[]> codes;
+    std::unique_ptr<int8_t[]> int8_codes;
+    std::unique_ptr<float[]> int8_scales;
+};
+
+// 이진 코드용 hnswlib 공간 (해밍 거리)
+// 이진 코드 위에 HNSW 그래프를 만들면 탐색 중에는 float 벡터를 전혀 읽지 않습니다.
+class HammingSpace : public hnswlib::SpaceInterface<float> {
+public:
+    explicit HammingSpace(size_t code_words) : words(code_words) {}
+
+    size_t get_data_size() override {
+        return words * sizeof(uint64_t);
+    }
+
+    hnswlib::DISTFUNC<float> get_dist_func() override {
+        return &distance;
+    }
+
+    void* get_dist_func_param() override {
+        return &words;
+    }
+
+private:
+    size_t words;
+
+    static float distance(const void* a, const void* b, const void* param) {
+        return static_cast<float>(BinaryIndex::hamming(static_cast<const uint64_t*>(a), static_cast<const uint64_t*>(b),
+                                                       *static_cast<const size_t*>(param)));
+    }
+};
@@ -1 +1,30 @@
-g++ -o vectordb_example main.cpp -lhnswlib -lsentencepiece -std=c++17
+# -march=native: 임베딩 엔진의 AVX2/NEON 커널 사용, -fopenmp: 배치/GEMM 병렬 처리
+g++ -o vectordb_example main.cpp -lhnswlib -lsentencepiece -std=c++17 -O3 -march=native -fopenmp
+
+# 도구 빌드: *_vectorDB.cpp 조각은 VectorDB 클래스 본문에 붙여야 하므로
+# vectorDB.cpp의 마지막 줄("};") 앞에 조각들을 넣고 *_main.cpp를 이어 붙여 하나의 번역 단위를 만듦
+# assemble <출력 파일> <main 파일> [조각 파일...]
+assemble() {
+    out=$1; main=$2; shift 2
+    {
+        sed '$d' vectorDB.cpp
+        for fragment in "$@"; do
+            cat "$fragment"
+        done
+        echo '};'
+        cat "$main"
+    } > "$out"
+}
+mkdir -p build
+
+# 오프라인 인덱스 빌더 (빌드 서버에서 실행, 결과 파일만 서빙 노드로 배포)
+assemble build/index_builder.cpp index_builder_main.cpp index_builder_vectorDB.cpp
+g++ -o index_builder build/index_builder.cpp -I. -lhnswlib -lsentencepiece -std=c++17 -O3 -march=native -fopenmp
+
+# 토큰화 처리량 벤치마크 (사용법: ./tokenizer_bench <tokenizer.model> [텍스트 파일] [반복 횟수])
+assemble build/tokenizer_bench.cpp tokenizer_bench_main.cpp
+g++ -o tokenizer_bench build/tokenizer_bench.cpp -I. -lhnswlib -lsentencepiece -std=c++17 -O3 -march=native -fopenmp
+
+# 오프라인 그래프 재배치 도구 (사용법: ./graph_reorder <데이터베이스 경로>)
+assemble build/graph_reorder.cpp graph_reorder_main.cpp
+g++ -o graph_reorder build/graph_reorder.cpp -I. -lhnswlib -lsentencepiece -std=c++17 -O3 -march=native -fopenmp
@@ -3,33 +3,594 @@ private:
     std::vector<VectorDB*> shards;
     int shard_count;
     int dimension;
+    int max_elements_per_shard;
+    
+    // 새로 만드는 샤드(분할, 재분배)에도 같은 토크나이저와 임베딩 모델을 로드하기 위한 경로
+    std::string tokenizer_path;
+    std::string embedding_model_path;
+    
+    // 센트로이드 라우팅 (enable_centroid_routing 호출 시 활성화)
+    // 샤드마다 k-means 센트로이드 하나를 두고, 벡터는 가장 가까운 센트로이드의 샤드에 저장하며
+    // 쿼리는 센트로이드와 가장 가까운 route_top_p개 샤드에만 보냅니다.
+    std::vector<std::vector<float>> centroids;
+    int route_top_p = 2;
+    double split_threshold = 0.9;     // 샤드가 용량의 이 비율을 넘으면 둘로 분할
+    std::shared_mutex topology_mutex; // 샤드 목록/센트로이드 변경 시 배타적, 추가/검색 시 공유
+    uint64_t topology_version = 0;    // 샤드 목록이 바뀔 때마다 증가 (topology_mutex 배타적 잠금 아래)
+    
+    // 샤드 복제본 (enable_replicas 호출 시 생성, shards와 같은 순서이며 추가는 양쪽 모두에 기록)
+    bool replication_enabled = false;
+    std::vector<VectorDB*> replicas;
+    
+    // 샤드별 응답 시간 통계 (지수 이동 평균, 마이크로초)
+    struct ShardHealth {
+        std::atomic<double> primary_latency_us{0.0};
+        std::atomic<double> replica_latency_us{0.0};
+        std::atomic<uint64_t> timeouts{0};
+        std::atomic<uint64_t> hedges{0};
+    };
+    std::vector<std::unique_ptr<ShardHealth>> health;
+    
+    // 마감 시간 기반 scatter-gather (enable_deadline_search 호출 시 활성화)
+    ThreadPool* gather_pool = nullptr;
+    std::chrono::microseconds default_budget{0};
+    double hedge_multiplier = 2.0;
+    int inflight_tasks = 0;                   // 마감 후에도 실행 중일 수 있는 샤드 검색 작업 수
+    std::mutex inflight_mutex;
+    std::condition_variable inflight_done;    // 마지막 작업이 끝나면 알림 (소멸자가 대기)
+    
+    void begin_inflight_task() {
+        std::lock_guard<std::mutex> lock(inflight_mutex);
+        inflight_tasks++;
+    }
+    
+    void end_inflight_task() {
+        // 잠금을 쥔 채로 알려야 소멸자가 condition_variable을 먼저 파괴하지 않음
+        std::lock_guard<std::mutex> lock(inflight_mutex);
+        if (--inflight_tasks == 0) {
+            inflight_done.notify_all();
+        }
+    }
+    
+    // 분산 검색 지표 (샤드별 지표는 각 VectorDB에 있음)
+    enum MetricHistogram { METRIC_SEARCH, METRIC_DEADLINE_SEARCH, METRIC_ADD };
+    enum MetricCounter {
+        COUNTER_QUERIES,
+        COUNTER_SHARD_FANOUT,      // 쿼리가 보내진 샤드 수의 합 (쿼리 수로 나누면 평균 팬아웃)
+        COUNTER_HEDGED_REQUESTS,
+        COUNTER_SHARD_TIMEOUTS,
+        COUNTER_DEGRADED_RESULTS,
+        COUNTER_QUERY_CACHE_HITS,
+        COUNTER_QUERY_CACHE_MISSES
+    };
+    MetricsRegistry metrics{{"search", "deadline_search", "add"},
+                            {"queries", "shard_fanout", "hedged_requests", "shard_timeouts", "degraded_results",
+                             "query_cache_hits", "query_cache_misses"}};
+    
+    // 병합된 검색 결과 캐시 (enable_query_cache 호출 시 생성)
+    std::unique_ptr<QueryResultCache> query_cache;
+    
+    // 모든 샤드 버전의 합 (어느 샤드든 삽입/삭제가 일어나면 증가)
+    // topology_mutex를 잡지 않은 상태에서 호출 (샤드 분할과 동시에 샤드 목록을 읽지 않도록)
+    uint64_t combined_index_version() {
+        std::shared_lock<std::shared_mutex> lock(topology_mutex);
+        uint64_t version = 0;
+        for (auto shard : shards) {
+            version += shard->get_index_version();
+        }
+        return version;
+    }
+    
+    // 비동기 API용 요청 병합기 (enable_async 호출 시 생성)
+    struct SearchRequest {
+        std::string query;
+        int k;
+        VectorDB::SimilarityType sim_type;
+    };
+    using SearchResult = std::vector<std::pair<std::string, float>>;
+    
+    // 한 쿼리의 샤드 응답 수집 상태 (마감 후에도 늦게 끝난 작업이 접근하므로 shared_ptr로 공유)
+    struct GatherState {
+        std::vector<float> query;
+        int k;
+        VectorDB::SimilarityType sim_type;
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::vector<SearchResult> results;
+        std::vector<bool> done;
+        size_t remaining = 0;
+    };
+    
+    std::unique_ptr<RequestCoalescer<SearchRequest, SearchResult>> search_coalescer;
+    std::unique_ptr<RequestCoalescer<std::pair<std::string, std::string>, bool>> add_coalescer;
+    
+    // 모인 검색 요청을 한 번에 임베딩한 뒤 샤드 검색
+    std::vector<SearchResult> run_search_batch(const std::vector<SearchRequest>& requests) {
+        std::vector<std::vector<float>> embeddings(requests.size());
+        
+        {
+            std::shared_lock<std::shared_mutex> lock(topology_mutex);
+            #pragma omp parallel for
+            for (size_t i = 0; i < requests.size(); i++) {
+                embeddings[i] = shards[0]->embed_query(requests[i].query);
+            }
+        }
+        
+        std::vector<SearchResult> results(requests.size());
+        
+        #pragma omp parallel for
+        for (size_t i = 0; i < requests.size(); i++) {
+            results[i] = search_by_embedding(embeddings[i], requests[i].k, requests[i].sim_type);
+        }
+        
+        return results;
+    }
+    
+    static float dot(const std::vector<float>& a, const float* b) {
+        float sum = 0.0f;
+        for (size_t i = 0; i < a.size(); i++) {
+            sum += a[i] * b[i];
+        }
+        return sum;
+    }
+    
+    // 구면 k-means (정규화된 임베딩이므로 내적이 클수록 가까움), k-means++ 초기화
+    static std::vector<std::vector<float>> train_centroids(const std::vector<std::vector<float>>& samples,
+                                                           int k, int iterations = 20) {
+        std::mt19937 rng(42);
+        std::vector<std::vector<float>> result;
+        if (samples.empty()) {
+            return result;
+        }
+        
+        // k-means++: 기존 센트로이드와 멀수록 높은 확률로 다음 센트로이드 선택
+        result.push_back(samples[rng() % samples.size()]);
+        std::vector<float> best(samples.size(), -2.0f);
+        while (static_cast<int>(result.size()) < k) {
+            std::vector<double> weights(samples.size());
+            double weight_sum = 0.0;
+            for (size_t i = 0; i < samples.size(); i++) {
+                best[i] = std::max(best[i], dot(result.back(), samples[i].data()));
+                weights[i] = std::max(0.0, 1.0 - best[i]);
+                weight_sum += weights[i];
+            }
+            if (weight_sum <= 0.0) {
+                // 모든 샘플이 이미 센트로이드와 같으면 가중치가 모두 0이므로 균등하게 선택
+                result.push_back(samples[rng() % samples.size()]);
+                continue;
+            }
+            std::discrete_distribution<size_t> pick(weights.begin(), weights.end());
+            result.push_back(samples[pick(rng)]);
+        }
+        
+        std::vector<int> assignment(samples.size(), -1);
+        for (int iter = 0; iter < iterations; iter++) {
+            bool changed = false;
+            for (size_t i = 0; i < samples.size(); i++) {
+                int nearest = nearest_centroid(result, samples[i].data());
+                if (nearest != assignment[i]) {
+                    assignment[i] = nearest;
+                    changed = true;
+                }
+            }
+            if (!changed) break;
+            
+            std::vector<std::vector<float>> sums(k, std::vector<float>(samples[0].size(), 0.0f));
+            std::vector<size_t> counts(k, 0);
+            for (size_t i = 0; i < samples.size(); i++) {
+                for (size_t j = 0; j < samples[i].size(); j++) {
+                    sums[assignment[i]][j] += samples[i][j];
+                }
+                counts[assignment[i]]++;
+            }
+            for (int c = 0; c < k; c++) {
+                if (counts[c] == 0) {
+                    // 빈 클러스터는 임의의 샘플로 다시 시작
+                    result[c] = samples[rng() % samples.size()];
+                    continue;
+                }
+                float norm = 0.0f;
+                for (float v : sums[c]) norm += v * v;
+                norm = std::sqrt(norm);
+                for (size_t j = 0; j < sums[c].size(); j++) {
+                    result[c][j] = norm > 0.0f ? sums[c][j] / norm : 0.0f;
+                }
+            }
+        }
+        return result;
+    }
+    
+    static int nearest_centroid(const std::vector<std::vector<float>>& centers, const float* embedding) {
+        int nearest = 0;
+        float best = -std::numeric_limits<float>::max();
+        for (size_t c = 0; c < centers.size(); c++) {
+            float similarity = dot(centers[c], embedding);
+            if (similarity > best) {
+                best = similarity;
+                nearest = static_cast<int>(c);
+            }
+        }
+        return nearest;
+    }
+    
+    // 쿼리를 보낼 샤드 (라우팅이 꺼져 있으면 전체, 켜져 있으면 센트로이드와 가까운 route_top_p개)
+    std::vector<int> target_shards(const std::vector<float>& query_embedding) const {
+        std::vector<int> targets(shards.size());
+        for (size_t i = 0; i < shards.size(); i++) {
+            targets[i] = static_cast<int>(i);
+        }
+        if (centroids.empty() || route_top_p >= static_cast<int>(shards.size())) {
+            return targets;
+        }
+        
+        std::vector<float> similarity(shards.size());
+        for (size_t i = 0; i < shards.size(); i++) {
+            similarity[i] = dot(centroids[i], query_embedding.data());
+        }
+        std::partial_sort(targets.begin(), targets.begin() + route_top_p, targets.end(),
+                          [&similarity](int a, int b) { return similarity[a] > similarity[b]; });
+        targets.resize(route_top_p);
+        return targets;
+    }
+    
+    static SearchResult merge_top_k(const std::vector<SearchResult>& shard_results, int k) {
+        SearchResult merged_results;
+        for (const auto& results : shard_results) {
+            merged_results.insert(merged_results.end(), results.begin(), results.end());
+        }
+        
+        // 점수로 정렬
+        std::sort(merged_results.begin(), merged_results.end(), 
+                 [](const auto& a, const auto& b) { return a.second > b.second; });
+        
+        // 상위 k개만 반환
+        if (merged_results.size() > k) {
+            merged_results.resize(k);
+        }
+        return merged_results;
+    }
+    
+    static void record_latency(std::atomic<double>& average, double sample_us) {
+        // 여러 작업이 동시에 갱신하면 표본 하나가 빠질 수 있지만 추세에는 영향이 없음
+        double previous = average.load(std::memory_order_relaxed);
+        average.store(previous == 0.0 ? sample_us : previous * 0.8 + sample_us * 0.2, std::memory_order_relaxed);
+    }
+    
+    // 샤드(또는 복제본) 검색 작업 제출
+    // 작업은 공유 잠금을 잡은 뒤 샤드 목록이 제출 시점과 같을 때만 검색하고, 먼저 도착한 응답만 기록합니다.
+    void dispatch_shard_search(const std::shared_ptr<GatherState>& state, size_t slot, int shard_idx,
+                               bool use_replica, bool hedge, uint64_t version) {
+        begin_inflight_task();
+        try {
+            gather_pool->enqueue([this, state, slot, shard_idx, use_replica, hedge, version]() {
+                auto start = std::chrono::steady_clock::now();
+                SearchResult result;
+                bool valid = false;
+                {
+                    std::shared_lock<std::shared_mutex> lock(topology_mutex);
+                    if (topology_version == version) {
+                        VectorDB* target = use_replica ? replicas[shard_idx] : shards[shard_idx];
+                        result = target->search_by_embedding(state->query, state->k, state->sim_type);
+                        valid = true;
+                        
+                        ShardHealth& shard_health = *health[shard_idx];
+                        double elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+                        record_latency(use_replica ? shard_health.replica_latency_us : shard_health.primary_latency_us, elapsed);
+                        if (hedge) shard_health.hedges++;
+                    }
+                }
+                if (valid) {
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    if (!state->done[slot]) {
+                        state->done[slot] = true;
+                        state->results[slot] = std::move(result);
+                        state->remaining--;
+                    }
+                }
+                state->cv.notify_all();
+                end_inflight_task();
+            });
+        } catch (const std::exception&) {
+            end_inflight_task(); // 풀이 종료됨: 해당 샤드는 마감 시 누락으로 처리
+        }
+    }
+    
+    // 샤드 목록 변경 후 복제본과 응답 시간 통계 재구성 (topology_mutex 배타적 잠금 아래에서 호출)
+    void refresh_topology() {
+        for (auto replica : replicas) {
+            delete replica;
+        }
+        replicas.clear();
+        if (replication_enabled) {
+            for (auto shard : shards) {
+                replicas.push_back(copy_shard(shard));
+            }
+        }
+        
+        health.clear();
+        for (size_t i = 0; i < shards.size(); i++) {
+            health.emplace_back(new ShardHealth());
+        }
+        topology_version++;
+    }
+    
+    // 새 샤드 생성 (로드된 토크나이저/모델 적용)
+    VectorDB* create_shard() {
+        VectorDB* shard = new VectorDB(dimension, max_elements_per_shard);
+        if (!tokenizer_path.empty()) shard->load_tokenizer(tokenizer_path);
+        if (!embedding_model_path.empty()) shard->load_embedding_model(embedding_model_path);
+        return shard;
+    }
+    
+    // 샤드 내용을 그대로 복사한 새 샤드 (복제본)
+    VectorDB* copy_shard(VectorDB* source) {
+        VectorDB* copy = create_shard();
+        source->for_each_entry([&](const std::string& text, const std::string& metadata, const float* vec) {
+            copy->add_with_embedding(text, metadata, std::vector<float>(vec, vec + dimension));
+        });
+        return copy;
+    }
+    
+    // 샤드와 (있으면) 복제본에 함께 기록
+    void store_entry(int shard_idx, const std::string& text, const std::string& metadata,
+                     const std::vector<float>& embedding) {
+        shards[shard_idx]->add_with_embedding(text, metadata, embedding);
+        if (!replicas.empty()) {
+            replicas[shard_idx]->add_with_embedding(text, metadata, embedding);
+        }
+    }
+    
+    // 라우팅 규칙에 따라 샤드에 추가 (topology_mutex를 공유로 잡은 상태에서 호출), 추가된 샤드 번호 반환
+    int add_routed(const std::string& text, const std::string& metadata, const std::vector<float>& embedding) {
+        int shard_idx = nearest_centroid(centroids, embedding.data());
+        store_entry(shard_idx, text, metadata, embedding);
+        return shard_idx;
+    }
+    
+    bool needs_split(int shard_idx) {
+        return shards[shard_idx]->size() >= split_threshold * max_elements_per_shard;
+    }
+    
+    // 샤드 분할: 샤드의 항목을 2-means로 나눠 기존 자리와 새 샤드에 다시 저장
+    void split_shard(int shard_idx) {
+        std::unique_lock<std::shared_mutex> lock(topology_mutex);
+        if (shard_idx >= static_cast<int>(shards.size()) || !needs_split(shard_idx)) {
+            return; // 다른 스레드가 이미 분할함
+        }
+        
+        std::vector<std::string> texts;
+        std::vector<std::string> metadatas;
+        std::vector<std::vector<float>> vectors;
+        shards[shard_idx]->for_each_entry([&](const std::string& text, const std::string& metadata, const float* vec) {
+            texts.push_back(text);
+            metadatas.push_back(metadata);
+            vectors.emplace_back(vec, vec + dimension);
+        });
+        
+        std::vector<std::vector<float>> halves = train_centroids(vectors, 2);
+        if (halves.size() < 2) {
+            return;
+        }
+        std::vector<int> assignment(vectors.size());
+        size_t left_count = 0;
+        for (size_t i = 0; i < vectors.size(); i++) {
+            assignment[i] = nearest_centroid(halves, vectors[i].data());
+            if (assignment[i] == 0) left_count++;
+        }
+        if (left_count == 0 || left_count == vectors.size()) {
+            // 항목들이 거의 같은 벡터라 둘로 나눌 수 없음 (나눠도 한쪽으로만 라우팅됨)
+            std::cerr << "샤드 " << shard_idx << "를 분할할 수 없습니다: 항목이 한 클러스터에 모여 있습니다." << std::endl;
+            return;
+        }
+        
+        std::vector<VectorDB*> parts = {create_shard(), create_shard()};
+        for (size_t i = 0; i < vectors.size(); i++) {
+            parts[assignment[i]]->add_with_embedding(texts[i], metadatas[i], vectors[i]);
+        }
+        
+        delete shards[shard_idx];
+        shards[shard_idx] = parts[0];
+        centroids[shard_idx] = halves[0];
+        shards.push_back(parts[1]);
+        centroids.push_back(halves[1]);
+        shard_count = static_cast<int>(shards.size());
+        
+        // 나뉜 두 샤드의 복제본과 통계만 새로 만듦
+        if (replication_enabled) {
+            delete replicas[shard_idx];
+            replicas[shard_idx] = copy_shard(parts[0]);
+            replicas.push_back(copy_shard(parts[1]));
+        }
+        health[shard_idx].reset(new ShardHealth());
+        health.emplace_back(new ShardHealth());
+        topology_version++;
+        if (query_cache) {
+            query_cache->clear();
+        }
+        
+        std::cout << "샤드 " << shard_idx << " 분할: " << parts[0]->size() << " / " << parts[1]->size()
+                  << " (전체 샤드 수: " << shard_count << ")" << std::endl;
+    }
     
 public:
     DistributedVectorDB(int dim = 384, int max_elems_per_shard = 1000, int num_shards = 3) 
-        : shard_count(num_shards), dimension(dim) {
+        : shard_count(num_shards), dimension(dim), max_elements_per_shard(max_elems_per_shard) {
         
         std::cout << num_shards << "개의 샤드로 분산 VectorDB를 초기화합니다." << std::endl;
         
         for (int i = 0; i < num_shards; i++) {
             shards.push_back(new VectorDB(dim, max_elems_per_shard));
             std::cout << "샤드 " << i << " 초기화됨" << std::endl;
+            health.emplace_back(new ShardHealth());
         }
+        
+        metrics.add_gauge("shards", [this]() { return static_cast<double>(shard_count); });
+        metrics.add_gauge("search_queue_depth", [this]() {
+            return search_coalescer ? static_cast<double>(search_coalescer->queue_depth()) : 0.0;
+        });
+        metrics.add_gauge("add_queue_depth", [this]() {
+            return add_coalescer ? static_cast<double>(add_coalescer->queue_depth()) : 0.0;
+        });
+        metrics.add_gauge("gather_queue_depth", [this]() {
+            return gather_pool ? static_cast<double>(gather_pool->queue_depth()) : 0.0;
+        });
     }
     
     ~DistributedVectorDB() {
+        // 처리 중인 비동기 요청이 샤드를 참조하므로 먼저 정리
+        search_coalescer.reset();
+        add_coalescer.reset();
+        
+        // 마감 후에도 계속 실행 중인 샤드 검색 작업이 끝날 때까지 대기
+        {
+            std::unique_lock<std::mutex> lock(inflight_mutex);
+            inflight_done.wait(lock, [this] { return inflight_tasks == 0; });
+        }
+        
         for (auto shard : shards) {
             delete shard;
         }
+        for (auto replica : replicas) {
+            delete replica;
+        }
+    }
+    
+    // 모든 샤드(이후 만들어지는 샤드 포함)에 토크나이저 로드
+    bool load_tokenizer(const std::string& model_path) {
+        std::unique_lock<std::shared_mutex> lock(topology_mutex);
+        tokenizer_path = model_path;
+        for (auto shard : shards) {
+            if (!shard->load_tokenizer(model_path)) return false;
+        }
+        return true;
+    }
+    
+    // 모든 샤드(이후 만들어지는 샤드 포함)에 임베딩 모델 로드
+    bool load_embedding_model(const std::string& model_path) {
+        std::unique_lock<std::shared_mutex> lock(topology_mutex);
+        embedding_model_path = model_path;
+        for (auto shard : shards) {
+            if (!shard->load_embedding_model(model_path)) return false;
+        }
+        return true;
     }
     
-    // 텍스트 추가 - 간단한 해싱으로 샤드 선택
+    // 텍스트 추가 - 센트로이드 라우팅이 켜져 있으면 가장 가까운 센트로이드의 샤드, 아니면 해싱으로 샤드 선택
     void add_text(const std::string& text, const std::string& metadata = "") {
-        // 간단한 해시 함수로 샤드 선택
-        size_t hash_val = std::hash<std::string>{}(text);
-        int shard_idx = hash_val % shard_count;
+        MetricsRegistry::Timer timer(metrics, METRIC_ADD);
+        int split_candidate = -1;
+        {
+            std::shared_lock<std::shared_mutex> lock(topology_mutex);
+            if (centroids.empty()) {
+                // 간단한 해시 함수로 샤드 선택
+                size_t hash_val = std::hash<std::string>{}(text);
+                int shard_idx = hash_val % shard_count;
+                
+                // 선택된 샤드에 추가 (복제본이 있으면 임베딩을 한 번만 계산해 양쪽에 기록)
+                if (replicas.empty()) {
+                    shards[shard_idx]->add_text(text, metadata);
+                } else {
+                    store_entry(shard_idx, text, metadata, shards[0]->embed_query(text));
+                }
+                return;
+            }
+            
+            std::vector<float> embedding = shards[0]->embed_query(text);
+            int shard_idx = add_routed(text, metadata, embedding);
+            if (needs_split(shard_idx)) {
+                split_candidate = shard_idx;
+            }
+        }
+        
+        // 분할은 배타적 잠금이 필요하므로 공유 잠금을 놓은 뒤 진행
+        if (split_candidate >= 0) {
+            split_shard(split_candidate);
+        }
+    }
+    
+    // 센트로이드 라우팅 활성화
+    // sample_texts(비어 있으면 이미 저장된 항목)로 샤드 수만큼의 센트로이드를 학습하고,
+    // 이미 저장된 항목은 가장 가까운 센트로이드의 샤드로 다시 분배합니다.
+    // 이후 쿼리는 top_p개 샤드에만 보내고, 용량의 split_ratio를 넘은 샤드는 둘로 분할합니다.
+    void enable_centroid_routing(const std::vector<std::string>& sample_texts, int top_p = 2,
+                                 double split_ratio = 0.9) {
+        std::unique_lock<std::shared_mutex> lock(topology_mutex);
+        
+        std::vector<std::string> texts;
+        std::vector<std::string> metadatas;
+        std::vector<std::vector<float>> vectors;
+        for (auto shard : shards) {
+            shard->for_each_entry([&](const std::string& text, const std::string& metadata, const float* vec) {
+                texts.push_back(text);
+                metadatas.push_back(metadata);
+                vectors.emplace_back(vec, vec + dimension);
+            });
+        }
+        
+        std::vector<std::vector<float>> samples;
+        if (sample_texts.empty()) {
+            samples = vectors;
+        } else {
+            samples.resize(sample_texts.size());
+            #pragma omp parallel for
+            for (size_t i = 0; i < sample_texts.size(); i++) {
+                samples[i] = shards[0]->embed_query(sample_texts[i]);
+            }
+        }
+        if (static_cast<int>(samples.size()) < shard_count) {
+            throw std::runtime_error("센트로이드 학습에는 샤드 수 이상의 샘플이 필요합니다.");
+        }
+        
+        centroids = train_centroids(samples, shard_count);
+        route_top_p = std::max(1, top_p);
+        split_threshold = split_ratio;
         
-        // 선택된 샤드에 추가
-        shards[shard_idx]->add_text(text, metadata);
+        // 기존 항목 재분배
+        if (!vectors.empty()) {
+            for (auto& shard : shards) {
+                delete shard;
+                shard = create_shard();
+            }
+            for (size_t i = 0; i < vectors.size(); i++) {
+                shards[nearest_centroid(centroids, vectors[i].data())]->add_with_embedding(texts[i], metadatas[i], vectors[i]);
+            }
+            refresh_topology();
+        }
+        if (query_cache) {
+            query_cache->clear();
+        }
+        
+        std::cout << "센트로이드 라우팅이 활성화되었습니다. 샤드 수: " << shard_count
+                  << ", 쿼리당 샤드 수: " << route_top_p << ", 재분배 항목 수: " << vectors.size() << std::endl;
+    }
+    
+    // 샤드별 항목 수
+    std::vector<size_t> shard_sizes() {
+        std::shared_lock<std::shared_mutex> lock(topology_mutex);
+        std::vector<size_t> sizes;
+        for (auto shard : shards) {
+            sizes.push_back(shard->size());
+        }
+        return sizes;
+    }
+    
+    // 샤드 균형 보고 (최대/평균 비율이 클수록 특정 샤드에 쏠림)
+    void report_shard_balance() {
+        std::vector<size_t> sizes = shard_sizes();
+        size_t total = 0;
+        size_t largest = 0;
+        for (size_t size : sizes) {
+            total += size;
+            largest = std::max(largest, size);
+        }
+        double mean = sizes.empty() ? 0.0 : static_cast<double>(total) / sizes.size();
+        
+        std::cout << "샤드 균형 보고 (" << (centroids.empty() ? "해시" : "센트로이드") << " 분배):" << std::endl;
+        for (size_t i = 0; i < sizes.size(); i++) {
+            std::cout << "- 샤드 " << i << ": " << sizes[i] << "개 ("
+                      << (100.0 * sizes[i] / max_elements_per_shard) << "% 사용)" << std::endl;
+        }
+        std::cout << "- 전체 " << total << "개, 최대/평균 비율: " << (mean > 0 ? largest / mean : 0.0) << std::endl;
     }
     
     // 배치 추가
@@ -45,33 +606,326 @@ public:
     std::vector<std::pair<std::string, float>> search(const std::string& query, 
                                                      int k = 5, 
                                                      VectorDB::SimilarityType sim_type = VectorDB::COSINE) {
-        // 각 샤드에서 k개씩 결과를 가져옴
+        // 쿼리 임베딩은 모든 샤드가 같은 모델을 쓰므로 한 번만 계산
+        std::vector<float> query_embedding;
+        {
+            std::shared_lock<std::shared_mutex> lock(topology_mutex);
+            query_embedding = shards[0]->embed_query(query);
+        }
+        
+        return search_by_embedding(query_embedding, k, sim_type);
+    }
+    
+    // 미리 계산된 쿼리 임베딩으로 모든 샤드 검색 후 결과 병합
+    std::vector<std::pair<std::string, float>> search_by_embedding(const std::vector<float>& query_embedding,
+                                                                  int k = 5,
+                                                                  VectorDB::SimilarityType sim_type = VectorDB::COSINE) {
+        MetricsRegistry::Timer timer(metrics, METRIC_SEARCH);
+        metrics.add(COUNTER_QUERIES);
+        
+        uint64_t version = combined_index_version();
+        std::vector<std::pair<std::string, float>> cached;
+        if (query_cache) {
+            if (query_cache->lookup(query_embedding, k, sim_type, "", version, cached)) {
+                metrics.add(COUNTER_QUERY_CACHE_HITS);
+                return cached;
+            }
+            metrics.add(COUNTER_QUERY_CACHE_MISSES);
+        }
+        
+        // 기본 마감 시간이 설정되어 있으면 scatter-gather로 검색 (일부 샤드가 누락된 결과는 캐시하지 않음)
+        if (gather_pool && default_budget.count() > 0) {
+            GatherResult gathered = search_by_embedding_with_deadline(query_embedding, k, default_budget, sim_type);
+            if (query_cache && !gathered.degraded) {
+                query_cache->insert(query_embedding, k, sim_type, "", version, gathered.results);
+            }
+            return gathered.results;
+        }
+        
+        // 대상 샤드에서 k개씩 결과를 가져옴
         std::vector<std::vector<std::pair<std::string, float>>> shard_results;
         
-        for (auto shard : shards) {
-            shard_results.push_back(shard->search(query, k, sim_type));
+        {
+            std::shared_lock<std::shared_mutex> lock(topology_mutex);
+            std::vector<int> targets = target_shards(query_embedding);
+            metrics.add(COUNTER_SHARD_FANOUT, targets.size());
+            for (int shard_idx : targets) {
+                shard_results.push_back(shards[shard_idx]->search_by_embedding(query_embedding, k, sim_type));
+            }
         }
         
         // 결과 병합 및 정렬
-        std::vector<std::pair<std::string, float>> merged_results;
-        for (const auto& results : shard_results) {
-            merged_results.insert(merged_results.end(), results.begin(), results.end());
+        std::vector<std::pair<std::string, float>> merged_results = merge_top_k(shard_results, k);
+        
+        if (query_cache) {
+            query_cache->insert(query_embedding, k, sim_type, "", version, merged_results);
         }
         
-        // 점수로 정렬
-        std::sort(merged_results.begin(), merged_results.end(), 
-                 [](const auto& a, const auto& b) { return a.second > b.second; });
+        return merged_results;
+    }
+    
+    // 마감 시간 검색 결과
+    struct GatherResult {
+        SearchResult results;
+        bool degraded = false;           // 마감 시간 안에 응답하지 않은 샤드가 있어 일부 결과만 병합됨
+        std::vector<int> missing_shards; // 응답하지 않은 샤드 번호
+        int hedged_requests = 0;         // 복제본에 추가로 보낸 요청 수
+    };
+    
+    // 마감 시간 기반 검색 활성화
+    // 샤드 검색을 pool에서 병렬로 실행하고, budget이 지나면 그때까지 도착한 결과만 병합합니다.
+    // 복제본이 있으면 평소보다 hedge_multiplier배 이상 늦는 샤드에 같은 요청을 복제본으로 한 번 더 보냅니다.
+    // default_budget이 0보다 크면 search/search_by_embedding도 이 경로를 사용합니다.
+    // (pool은 이 객체보다 오래 살아야 하며, enable_async의 pool과 같으면 배치 작업이 샤드 작업을 기다리며
+    //  작업자를 점유하므로 별도의 pool을 권장)
+    void enable_deadline_search(ThreadPool& pool,
+                                std::chrono::microseconds budget = std::chrono::microseconds(0),
+                                double multiplier = 2.0) {
+        gather_pool = &pool;
+        default_budget = budget;
+        hedge_multiplier = multiplier;
+    }
+    
+    // 모든 샤드에 복제본을 하나씩 만들고, 이후 추가되는 항목도 양쪽에 기록
+    void enable_replicas() {
+        std::unique_lock<std::shared_mutex> lock(topology_mutex);
+        replication_enabled = true;
+        refresh_topology();
+        std::cout << shards.size() << "개 샤드의 복제본이 생성되었습니다." << std::endl;
+    }
+    
+    // 마감 시간 안에서 검색
+    GatherResult search_with_deadline(const std::string& query, int k, std::chrono::microseconds budget,
+                                      VectorDB::SimilarityType sim_type = VectorDB::COSINE) {
+        std::vector<float> query_embedding;
+        {
+            std::shared_lock<std::shared_mutex> lock(topology_mutex);
+            query_embedding = shards[0]->embed_query(query);
+        }
+        return search_by_embedding_with_deadline(query_embedding, k, budget, sim_type);
+    }
+    
+    GatherResult search_by_embedding_with_deadline(const std::vector<float>& query_embedding, int k,
+                                                   std::chrono::microseconds budget,
+                                                   VectorDB::SimilarityType sim_type = VectorDB::COSINE) {
+        if (!gather_pool) {
+            throw std::runtime_error("마감 시간 검색이 활성화되지 않았습니다. enable_deadline_search를 먼저 호출하세요.");
+        }
         
-        // 상위 k개만 반환
-        if (merged_results.size() > k) {
-            merged_results.resize(k);
+        MetricsRegistry::Timer timer(metrics, METRIC_DEADLINE_SEARCH);
+        auto start = std::chrono::steady_clock::now();
+        auto deadline = start + budget;
+        auto state = std::make_shared<GatherState>();
+        state->query = query_embedding;
+        state->k = k;
+        state->sim_type = sim_type;
+        
+        GatherResult gathered;
+        std::vector<int> targets;
+        std::vector<bool> replica_first;
+        std::vector<bool> hedged;
+        std::vector<std::chrono::steady_clock::time_point> hedge_at;
+        uint64_t version;
+        {
+            std::shared_lock<std::shared_mutex> lock(topology_mutex);
+            version = topology_version;
+            targets = target_shards(query_embedding);
+            metrics.add(COUNTER_SHARD_FANOUT, targets.size());
+            state->results.resize(targets.size());
+            state->done.assign(targets.size(), false);
+            state->remaining = targets.size();
+            
+            // 대상 샤드들의 평소 응답 시간 (중앙값)
+            std::vector<double> latencies;
+            for (int shard_idx : targets) {
+                double latency = health[shard_idx]->primary_latency_us.load(std::memory_order_relaxed);
+                if (latency > 0.0) latencies.push_back(latency);
+            }
+            double typical = 0.0;
+            if (!latencies.empty()) {
+                std::nth_element(latencies.begin(), latencies.begin() + latencies.size() / 2, latencies.end());
+                typical = latencies[latencies.size() / 2];
+            }
+            
+            for (size_t slot = 0; slot < targets.size(); slot++) {
+                ShardHealth& shard_health = *health[targets[slot]];
+                double primary = shard_health.primary_latency_us.load(std::memory_order_relaxed);
+                double replica = shard_health.replica_latency_us.load(std::memory_order_relaxed);
+                
+                // 복제본이 더 빠르면 복제본으로 먼저 보냄
+                bool first = !replicas.empty() && replica > 0.0 && replica < primary;
+                replica_first.push_back(first);
+                dispatch_shard_search(state, slot, targets[slot], first, false, version);
+                
+                if (replicas.empty()) {
+                    hedged.push_back(true); // 헤지할 복제본 없음
+                    hedge_at.push_back(deadline);
+                    continue;
+                }
+                
+                double expected = first ? replica : primary;
+                if (typical > 0.0 && expected > hedge_multiplier * typical) {
+                    // 꾸준히 느린 샤드는 기다리지 않고 바로 헤지
+                    dispatch_shard_search(state, slot, targets[slot], !first, true, version);
+                    gathered.hedged_requests++;
+                    hedged.push_back(true);
+                    hedge_at.push_back(deadline);
+                } else {
+                    // 통계가 없으면 예산의 절반이 지났을 때 헤지
+                    double delay_us = typical > 0.0 ? hedge_multiplier * std::max(expected, typical)
+                                                    : budget.count() / 2.0;
+                    hedged.push_back(false);
+                    hedge_at.push_back(start + std::chrono::microseconds(static_cast<int64_t>(delay_us)));
+                }
+            }
         }
         
-        return merged_results;
+        // 마감 시간 또는 다음 헤지 시점까지 응답 대기
+        std::vector<SearchResult> shard_results;
+        {
+            std::unique_lock<std::mutex> lock(state->mutex);
+            while (state->remaining > 0) {
+                auto now = std::chrono::steady_clock::now();
+                if (now >= deadline) break;
+                
+                auto wake = deadline;
+                for (size_t slot = 0; slot < targets.size(); slot++) {
+                    if (hedged[slot] || state->done[slot]) continue;
+                    if (hedge_at[slot] <= now) {
+                        dispatch_shard_search(state, slot, targets[slot], !replica_first[slot], true, version);
+                        gathered.hedged_requests++;
+                        hedged[slot] = true;
+                    } else {
+                        wake = std::min(wake, hedge_at[slot]);
+                    }
+                }
+                state->cv.wait_until(lock, wake);
+            }
+            
+            for (size_t slot = 0; slot < targets.size(); slot++) {
+                if (state->done[slot]) {
+                    shard_results.push_back(std::move(state->results[slot]));
+                } else {
+                    gathered.missing_shards.push_back(targets[slot]);
+                    state->done[slot] = true; // 늦게 도착한 응답은 버림
+                }
+            }
+        }
+        
+        // 마감을 넘긴 샤드는 예산만큼 걸린 것으로 기록해 이후 쿼리에서 헤지 대상이 되도록 함
+        if (!gathered.missing_shards.empty()) {
+            gathered.degraded = true;
+            std::shared_lock<std::shared_mutex> lock(topology_mutex);
+            if (topology_version == version) {
+                for (int shard_idx : gathered.missing_shards) {
+                    health[shard_idx]->timeouts++;
+                    record_latency(health[shard_idx]->primary_latency_us, static_cast<double>(budget.count()));
+                }
+            }
+        }
+        
+        metrics.add(COUNTER_HEDGED_REQUESTS, gathered.hedged_requests);
+        if (gathered.degraded) {
+            metrics.add(COUNTER_SHARD_TIMEOUTS, gathered.missing_shards.size());
+            metrics.add(COUNTER_DEGRADED_RESULTS);
+        }
+        
+        gathered.results = merge_top_k(shard_results, k);
+        return gathered;
+    }
+    
+    // 분산 검색 지표 스냅샷
+    MetricsRegistry::Snapshot metrics_snapshot() {
+        return metrics.snapshot();
+    }
+    
+    // Prometheus 텍스트 형식: 분산 지표(vectordb_distributed_*)와 샤드별 지표(vectordb_*{shard="i"})
+    std::string metrics_prometheus() {
+        std::vector<std::pair<MetricsRegistry::Snapshot, std::string>> shard_snapshots;
+        {
+            std::shared_lock<std::shared_mutex> lock(topology_mutex);
+            for (size_t i = 0; i < shards.size(); i++) {
+                shard_snapshots.emplace_back(shards[i]->metrics_snapshot(), "shard=\"" + std::to_string(i) + "\"");
+            }
+        }
+        return MetricsRegistry::prometheus_text("vectordb_distributed_", {{metrics.snapshot(), ""}}) +
+               MetricsRegistry::prometheus_text("vectordb_", shard_snapshots);
+    }
+    
+    // 샤드별 응답 시간 보고
+    void report_shard_latency() {
+        std::shared_lock<std::shared_mutex> lock(topology_mutex);
+        std::cout << "샤드 응답 시간 (이동 평균):" << std::endl;
+        for (size_t i = 0; i < health.size(); i++) {
+            std::cout << "- 샤드 " << i << ": " << health[i]->primary_latency_us.load() << "us";
+            if (!replicas.empty()) {
+                std::cout << ", 복제본 " << health[i]->replica_latency_us.load() << "us";
+            }
+            std::cout << ", 마감 초과 " << health[i]->timeouts.load()
+                      << "회, 헤지 " << health[i]->hedges.load() << "회" << std::endl;
+        }
+    }
+    
+    // 비동기 API 활성화 (pool은 이 객체보다 오래 살아야 함)
+    void enable_async(ThreadPool& pool,
+                      std::chrono::microseconds window = std::chrono::microseconds(2000),
+                      size_t max_batch = 32) {
+        search_coalescer.reset(new RequestCoalescer<SearchRequest, SearchResult>(
+            pool,
+            [this](const std::vector<SearchRequest>& requests) { return run_search_batch(requests); },
+            window, max_batch));
+        
+        add_coalescer.reset(new RequestCoalescer<std::pair<std::string, std::string>, bool>(
+            pool,
+            [this](const std::vector<std::pair<std::string, std::string>>& requests) {
+                // VectorDB::append_entry가 잠금을 사용하므로 같은 샤드에 동시에 추가해도 안전함
+                std::vector<bool> done(requests.size(), true);
+                #pragma omp parallel for
+                for (size_t i = 0; i < requests.size(); i++) {
+                    add_text(requests[i].first, requests[i].second);
+                }
+                return done;
+            },
+            window, max_batch));
+    }
+    
+    // 비동기 검색
+    std::future<SearchResult> search_async(const std::string& query, int k = 5,
+                                           VectorDB::SimilarityType sim_type = VectorDB::COSINE) {
+        if (!search_coalescer) {
+            throw std::runtime_error("비동기 API가 활성화되지 않았습니다. enable_async를 먼저 호출하세요.");
+        }
+        return search_coalescer->submit(SearchRequest{query, k, sim_type});
+    }
+    
+    // 비동기 추가
+    std::future<bool> add_async(const std::string& text, const std::string& metadata = "") {
+        if (!add_coalescer) {
+            throw std::runtime_error("비동기 API가 활성화되지 않았습니다. enable_async를 먼저 호출하세요.");
+        }
+        return add_coalescer->submit(std::make_pair(text, metadata));
+    }
+    
+    // 병합된 검색 결과 캐시 활성화
+    void enable_query_cache(size_t capacity = 1024, float similarity_threshold = 0.98f) {
+        query_cache.reset(new QueryResultCache(dimension, 16, similarity_threshold, capacity));
     }
     
     // 저장 및 로드 기능
     bool save(const std::string& base_path) {
+        std::shared_lock<std::shared_mutex> lock(topology_mutex);
+        
+        // 센트로이드 라우팅 정보 (분할로 샤드 수가 바뀌었을 수 있으므로 함께 저장)
+        if (!centroids.empty()) {
+            json routing;
+            routing["shard_count"] = shard_count;
+            routing["top_p"] = route_top_p;
+            routing["split_threshold"] = split_threshold;
+            routing["centroids"] = centroids;
+            std::ofstream file(base_path + "_routing.json");
+            file << routing.dump();
+        }
+        
         for (int i = 0; i < shard_count; i++) {
             std::string shard_path = base_path + "_shard" + std::to_string(i);
             if (!shards[i]->save(shard_path)) {
@@ -81,7 +935,32 @@ public:
         return true;
     }
     
+    // 라우팅 정보(_routing.json)가 있으면 그 샤드 수와 센트로이드를 사용
     bool load(const std::string& base_path, int num_shards) {
+        std::unique_lock<std::shared_mutex> lock(topology_mutex);
+        
+        centroids.clear();
+        std::ifstream routing_file(base_path + "_routing.json");
+        if (routing_file.is_open()) {
+            json routing;
+            routing_file >> routing;
+            std::vector<std::vector<float>> loaded_centroids = routing["centroids"].get<std::vector<std::vector<float>>>();
+            int loaded_shard_count = routing["shard_count"];
+            // 센트로이드 번호가 곧 샤드 번호이므로 개수와 차원이 맞지 않으면 라우팅할 수 없음
+            bool valid = static_cast<int>(loaded_centroids.size()) == loaded_shard_count;
+            for (const auto& centroid : loaded_centroids) {
+                valid = valid && static_cast<int>(centroid.size()) == dimension;
+            }
+            if (!valid) {
+                std::cerr << "라우팅 정보가 샤드 구성과 맞지 않습니다: " << base_path << "_routing.json" << std::endl;
+                return false;
+            }
+            num_shards = loaded_shard_count;
+            route_top_p = routing["top_p"];
+            split_threshold = routing["split_threshold"];
+            centroids = std::move(loaded_centroids);
+        }
+        
         // 기존 샤드 제거
         for (auto shard : shards) {
             delete shard;
@@ -90,17 +969,25 @@ public:
         
         // 새 샤드 로드
         shard_count = num_shards;
+        if (query_cache) {
+            query_cache->clear();
+        }
         for (int i = 0; i < num_shards; i++) {
             std::string shard_path = base_path + "_shard" + std::to_string(i);
             
-            VectorDB* new_shard = new VectorDB();
+            VectorDB* new_shard = create_shard();
             if (!new_shard->load(shard_path)) {
                 delete new_shard;
+                shard_count = static_cast<int>(shards.size());
+                // 로드된 샤드보다 센트로이드가 많으면 범위 밖 샤드로 라우팅되므로 라우팅을 끔
+                centroids.clear();
+                refresh_topology();
                 return false;
             }
             
             shards.push_back(new_shard);
         }
+        refresh_topology();
         return true;
     }
 };
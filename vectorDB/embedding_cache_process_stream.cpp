@@ -5,14 +5,26 @@ private:
 
     // 임베딩 함수 업데이트 (캐싱 추가)
     std::vector<float> embed_text(const std::string& text) {
+        MetricsRegistry::Timer timer(metrics, METRIC_EMBED);
+        
         // 캐시에서 확인
         auto it = embedding_cache.find(text);
         if (it != embedding_cache.end()) {
+            metrics.add(COUNTER_EMBEDDING_CACHE_HITS);
             return it->second;
         }
         
-        // 캐시에 없으면 새로 계산
-        std::vector<float> embedding = calculate_embedding(text);
+        // 메모리 캐시에 없으면 디스크 캐시 확인 후 새로 계산 (다른 프로세스나 이전 실행이 계산한 임베딩 재사용)
+        std::vector<float> embedding(embedding_dim);
+        if (persistent_cache && persistent_cache->lookup(embedding_source(), text, embedding.data())) {
+            metrics.add(COUNTER_EMBEDDING_CACHE_HITS);
+        } else {
+            metrics.add(COUNTER_EMBEDDING_CACHE_MISSES);
+            embedding = calculate_embedding(text);
+            if (persistent_cache) {
+                persistent_cache->insert(embedding_source(), text, embedding.data());
+            }
+        }
         
         // 캐시가 최대 크기에 도달했으면 랜덤하게 하나 제거
         if (embedding_cache.size() >= max_cache_size) {
@@ -29,25 +41,10 @@ private:
     
     // 실제 임베딩 계산 함수
     std::vector<float> calculate_embedding(const std::string& text) {
-        // 기존 임베딩 코드와 동일
-        std::vector<std::string> tokens;
-        std::vector<int> ids;
-        tokenizer->Encode(text, &tokens);
-        
-        // 토큰 ID로 변환
-        for (const auto& token : tokens) {
-            ids.push_back(tokenizer->PieceToId(token));
-        }
-        
-        // 간단한 임베딩 생성
-        std::vector<float> embedding(embedding_dim, 0.0f);
-        for (size_t i = 0; i < ids.size() && i < 512; i++) {
-            for (int j = 0; j < embedding_dim; j++) {
-                embedding[j] += std::sin(ids[i] * (j + 1.0f) / embedding_dim);
-            }
-        }
-        
-        return normalize_vector(embedding);
+        // 토큰 ID로 바로 인코딩 (스레드별 버퍼 재사용) 후 모델 또는 간단한 임베딩 적용
+        thread_local std::vector<int> ids;
+        encode_ids(text, ids);
+        return embed_ids(ids);
     }
 
 public:
@@ -0,0 +1,103 @@
+# MiniLM 계열 문장 임베딩 모델을 MiniLMEmbedder(minilm_embedder.cpp) 가중치 파일로 변환
+# 사용법: python export_minilm.py <모델 이름 또는 경로> <출력 파일> [--int8]
+# 예: python export_minilm.py sentence-transformers/paraphrase-multilingual-MiniLM-L12-v2 minilm.bin --int8
+# (SentencePiece 토크나이저를 쓰는 XLM-R 계열 모델이면 VectorDB::load_tokenizer에 같은 모델의
+#  sentencepiece.bpe.model을 로드하면 됩니다)
+import struct
+import sys
+
+import numpy as np
+from transformers import AutoModel, AutoTokenizer
+
+
+def write_matrix(f, m, quantize):
+    m = m.astype(np.float32)
+    if quantize:
+        scales = np.abs(m).max(axis=1) / 127.0
+        scales[scales == 0] = 1.0
+        q = np.clip(np.round(m / scales[:, None]), -127, 127).astype(np.int8)
+        f.write(scales.astype(np.float32).tobytes())
+        f.write(q.tobytes())
+    else:
+        f.write(m.tobytes())
+
+
+def write_vector(f, v):
+    f.write(v.astype(np.float32).tobytes())
+
+
+def sentencepiece_mapping(tokenizer):
+    """(SentencePiece ID에 더할 오프셋, SentencePiece unk ID) 반환
+
+    model_type은 인코더 구조만 알려 주므로 어휘 매핑은 토크나이저에서 구합니다.
+    (예: paraphrase-multilingual-MiniLM-L12-v2는 model_type이 bert지만 XLM-R SentencePiece 어휘를 사용)
+    SentencePiece 모델이 없는 토크나이저(WordPiece 등)면 ID를 그대로 쓰고 unk 변환도 하지 않습니다.
+    """
+    vocab_file = getattr(tokenizer, "vocab_file", None)
+    if not vocab_file or not vocab_file.endswith(".model"):
+        return 0, -1
+
+    import sentencepiece as spm
+    sp = spm.SentencePieceProcessor(model_file=vocab_file)
+
+    # 느린 XLM-R 토크나이저는 fairseq 오프셋을 직접 가지고, 빠른 토크나이저는 어휘 매핑을 비교해 구함
+    offset = getattr(tokenizer, "fairseq_offset", None)
+    if offset is None:
+        vocab = tokenizer.get_vocab()
+        diffs = {vocab[sp.id_to_piece(i)] - i for i in range(sp.get_piece_size())
+                 if not (sp.is_unknown(i) or sp.is_control(i)) and sp.id_to_piece(i) in vocab}
+        if len(diffs) != 1:
+            raise ValueError("SentencePiece ID와 모델 어휘 ID의 대응이 일정한 오프셋이 아닙니다: %s" % sorted(diffs)[:5])
+        offset = diffs.pop()
+    return offset, sp.unk_id()
+
+
+def main(model_name, output_path, quantize):
+    model = AutoModel.from_pretrained(model_name).eval()
+    tokenizer = AutoTokenizer.from_pretrained(model_name)
+    cfg = model.config
+    sd = {k: v.float().numpy() for k, v in model.state_dict().items()}
+
+    # 어휘 오프셋과 unk는 토크나이저 기준 (SentencePiece unk는 오프셋 없이 모델의 unk_token_id로 대응)
+    token_id_offset, sp_unk_id = sentencepiece_mapping(tokenizer)
+    # 위치 임베딩은 인코더 구조 기준: RoBERTa 계열은 padding_idx + 1부터 시작
+    roberta = cfg.model_type in ("xlm-roberta", "roberta")
+    position_offset = cfg.pad_token_id + 1 if roberta else 0
+
+    with open(output_path, "wb") as f:
+        f.write(b"MINILM02")
+        f.write(struct.pack("<13i", cfg.vocab_size, cfg.hidden_size, cfg.num_hidden_layers,
+                            cfg.num_attention_heads, cfg.intermediate_size, cfg.max_position_embeddings,
+                            1 if quantize else 0, tokenizer.cls_token_id, tokenizer.sep_token_id,
+                            token_id_offset, position_offset, sp_unk_id, tokenizer.unk_token_id))
+        f.write(struct.pack("<f", cfg.layer_norm_eps))
+
+        write_matrix(f, sd["embeddings.word_embeddings.weight"], quantize)
+        write_vector(f, sd["embeddings.position_embeddings.weight"])
+        write_vector(f, sd["embeddings.token_type_embeddings.weight"][0])
+        write_vector(f, sd["embeddings.LayerNorm.weight"])
+        write_vector(f, sd["embeddings.LayerNorm.bias"])
+
+        for i in range(cfg.num_hidden_layers):
+            p = "encoder.layer.%d." % i
+            for name in ("attention.self.query", "attention.self.key", "attention.self.value",
+                         "attention.output.dense"):
+                write_matrix(f, sd[p + name + ".weight"], quantize)
+                write_vector(f, sd[p + name + ".bias"])
+            write_vector(f, sd[p + "attention.output.LayerNorm.weight"])
+            write_vector(f, sd[p + "attention.output.LayerNorm.bias"])
+            for name in ("intermediate.dense", "output.dense"):
+                write_matrix(f, sd[p + name + ".weight"], quantize)
+                write_vector(f, sd[p + name + ".bias"])
+            write_vector(f, sd[p + "output.LayerNorm.weight"])
+            write_vector(f, sd[p + "output.LayerNorm.bias"])
+
+    print("변환 완료: %s (차원 %d, 레이어 %d, %s)" % (output_path, cfg.hidden_size, cfg.num_hidden_layers,
+                                                  "int8" if quantize else "fp32"))
+
+
+if __name__ == "__main__":
+    if len(sys.argv) < 3:
+        print("사용법: python export_minilm.py <모델> <출력 파일> [--int8]")
+        sys.exit(1)
+    main(sys.argv[1], sys.argv[2], "--int8" in sys.argv[3:])
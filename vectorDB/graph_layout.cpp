@@ -0,0 +1,320 @@
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <limits>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_set>
+#include <hnswlib/hnswlib.h>
+
+// HNSW 그래프 메모리 배치 최적화
+// 삽입 순서로 매겨진 내부 ID는 그래프상 이웃을 메모리 여기저기에 흩어 놓으므로 탐색이 캐시 미스에 묶입니다.
+// GraphReorder는 바닥 레이어를 진입점부터 BFS(이웃은 차수 오름차순, Cuthill-McKee 순서)로 훑어
+// 연결된 노드가 가까운 내부 ID를 갖도록 hnswlib의 내부 ID를 재배치합니다.
+// 외부 ID(라벨)는 각 원소 블록과 label_lookup_에 그대로 남으므로 VectorDB의 ID는 바뀌지 않습니다.
+class GraphReorder {
+public:
+    // 재배치된 메모리 (원본은 읽기만 하므로 동결된 세대는 검색을 받으면서 준비 가능)
+    struct Layout {
+        char* level0 = nullptr;
+        char** link_lists = nullptr;
+        std::vector<int> levels;
+        std::vector<hnswlib::tableint> old_to_new;
+        size_t count = 0;
+
+        ~Layout() {
+            // apply 이후에는 인덱스가 소유하므로 둘 다 nullptr
+            if (link_lists != nullptr) {
+                for (size_t i = 0; i < count; i++) {
+                    if (levels[i] > 0) std::free(link_lists[i]);
+                }
+                std::free(link_lists);
+            }
+            std::free(level0);
+        }
+    };
+
+    // 새 순서 (새 내부 ID -> 기존 내부 ID)
+    static std::vector<hnswlib::tableint> compute_order(hnswlib::HierarchicalNSW<float>& graph) {
+        size_t n = graph.cur_element_count;
+        std::vector<hnswlib::tableint> order;
+        order.reserve(n);
+        std::vector<bool> visited(n, false);
+
+        auto degree = [&graph](hnswlib::tableint id) {
+            return graph.getListCount(graph.get_linklist0(id));
+        };
+
+        std::vector<hnswlib::tableint> neighbors;
+        auto bfs = [&](hnswlib::tableint start) {
+            std::queue<hnswlib::tableint> frontier;
+            visited[start] = true;
+            frontier.push(start);
+            while (!frontier.empty()) {
+                hnswlib::tableint current = frontier.front();
+                frontier.pop();
+                order.push_back(current);
+
+                hnswlib::linklistsizeint* links = graph.get_linklist0(current);
+                int size = graph.getListCount(links);
+                hnswlib::tableint* ids = reinterpret_cast<hnswlib::tableint*>(links + 1);
+                neighbors.assign(ids, ids + size);
+                std::sort(neighbors.begin(), neighbors.end(), [&degree](hnswlib::tableint a, hnswlib::tableint b) {
+                    return degree(a) < degree(b);
+                });
+                for (hnswlib::tableint neighbor : neighbors) {
+                    if (neighbor < n && !visited[neighbor]) {
+                        visited[neighbor] = true;
+                        frontier.push(neighbor);
+                    }
+                }
+            }
+        };
+
+        // 진입점이 0번이 되도록 진입점부터 시작하고, 연결되지 않은 나머지도 순서대로 추가
+        if (n > 0) bfs(graph.enterpoint_node_);
+        for (hnswlib::tableint id = 0; id < n; id++) {
+            if (!visited[id]) bfs(id);
+        }
+        return order;
+    }
+
+    // 새 순서대로 원소 블록과 상위 레이어 링크를 복사하고 이웃 ID를 새 ID로 변환
+    static void build(hnswlib::HierarchicalNSW<float>& graph, const std::vector<hnswlib::tableint>& order,
+                      Layout& layout) {
+        size_t n = order.size();
+        layout.count = n;
+        layout.old_to_new.assign(n, 0);
+        for (size_t new_id = 0; new_id < n; new_id++) {
+            layout.old_to_new[order[new_id]] = static_cast<hnswlib::tableint>(new_id);
+        }
+
+        layout.level0 = static_cast<char*>(std::malloc(graph.max_elements_ * graph.size_data_per_element_));
+        layout.link_lists = static_cast<char**>(std::calloc(graph.max_elements_, sizeof(char*)));
+        layout.levels.assign(graph.element_levels_.size(), 0);
+        if (layout.level0 == nullptr || layout.link_lists == nullptr) {
+            throw std::runtime_error("그래프 재배치용 메모리를 할당할 수 없습니다.");
+        }
+
+        auto remap = [&layout](hnswlib::linklistsizeint* links, int size) {
+            hnswlib::tableint* ids = reinterpret_cast<hnswlib::tableint*>(links + 1);
+            for (int i = 0; i < size; i++) {
+                ids[i] = layout.old_to_new[ids[i]];
+            }
+        };
+
+        for (size_t new_id = 0; new_id < n; new_id++) {
+            hnswlib::tableint old_id = order[new_id];
+
+            // 바닥 레이어 블록: [링크 목록 | 벡터 | 라벨] (삭제 표시는 링크 목록 헤더에 있어 함께 복사됨)
+            char* block = layout.level0 + new_id * graph.size_data_per_element_;
+            std::memcpy(block, graph.data_level0_memory_ + old_id * graph.size_data_per_element_,
+                        graph.size_data_per_element_);
+            hnswlib::linklistsizeint* links0 = reinterpret_cast<hnswlib::linklistsizeint*>(block + graph.offsetLevel0_);
+            remap(links0, graph.getListCount(links0));
+
+            // 상위 레이어 링크
+            int level = graph.element_levels_[old_id];
+            layout.levels[new_id] = level;
+            if (level > 0) {
+                size_t bytes = graph.size_links_per_element_ * level + 1;
+                layout.link_lists[new_id] = static_cast<char*>(std::malloc(bytes));
+                std::memcpy(layout.link_lists[new_id], graph.linkLists_[old_id], bytes);
+                for (int l = 1; l <= level; l++) {
+                    hnswlib::linklistsizeint* links = reinterpret_cast<hnswlib::linklistsizeint*>(
+                        layout.link_lists[new_id] + (l - 1) * graph.size_links_per_element_);
+                    remap(links, graph.getListCount(links));
+                }
+            }
+        }
+    }
+
+    // 재배치 적용 (호출 중 이 그래프를 읽거나 쓰는 스레드가 없어야 함)
+    static void apply(hnswlib::HierarchicalNSW<float>& graph, Layout& layout) {
+        // hnswlib은 linkLists_를 초기화하지 않고 상위 레이어가 있는 원소에만 할당하므로 그 항목만 해제
+        for (size_t i = 0; i < layout.count; i++) {
+            if (graph.element_levels_[i] > 0) std::free(graph.linkLists_[i]);
+        }
+        std::free(graph.linkLists_);
+        std::free(graph.data_level0_memory_);
+
+        graph.data_level0_memory_ = layout.level0;
+        graph.linkLists_ = layout.link_lists;
+        graph.element_levels_ = layout.levels;
+        graph.enterpoint_node_ = layout.old_to_new[graph.enterpoint_node_];
+
+        {
+            std::lock_guard<std::mutex> lock(graph.label_lookup_lock);
+            for (auto& entry : graph.label_lookup_) {
+                entry.second = layout.old_to_new[entry.second];
+            }
+        }
+        std::unordered_set<hnswlib::tableint> deleted;
+        for (hnswlib::tableint id : graph.deleted_elements) {
+            deleted.insert(layout.old_to_new[id]);
+        }
+        graph.deleted_elements.swap(deleted);
+
+        layout.level0 = nullptr;
+        layout.link_lists = nullptr;
+    }
+
+    // 제자리 재배치 (호출 중 이 그래프를 사용하는 스레드가 없어야 함)
+    static void reorder(hnswlib::HierarchicalNSW<float>& graph) {
+        if (graph.cur_element_count < 2) {
+            return;
+        }
+        Layout layout;
+        build(graph, compute_order(graph), layout);
+        apply(graph, layout);
+    }
+};
+
+// 탐색 통계 (explain 검색에서만 넘기며, 여러 세대를 검색하면 합산)
+struct TraversalStats {
+    std::vector<size_t> visited_per_layer;   // 레이어별 방문 노드 수 (인덱스 0이 바닥 레이어)
+    size_t distance_computations = 0;
+    size_t effective_ef = 0;                 // 바닥 레이어 탐색에 사용된 ef (max(ef, k))
+    size_t hops = 0;                         // hnswlib searchKnn으로 검색한 그래프의 이동 횟수 (레이어 구분 없음)
+
+    void visit(int level) {
+        if (visited_per_layer.size() <= static_cast<size_t>(level)) {
+            visited_per_layer.resize(level + 1, 0);
+        }
+        visited_per_layer[level]++;
+    }
+};
+
+// hnswlib searchKnn으로 검색하는 그래프(지표 그래프, 이진 그래프)는 라이브러리 자체 카운터의 증가분으로 기록
+// 카운터는 그래프 단위로 누적되므로 같은 그래프를 동시에 검색하는 요청이 있으면 그만큼 함께 집계됩니다.
+template<typename Search>
+inline void count_hnswlib_search(hnswlib::HierarchicalNSW<float>& graph, size_t k, TraversalStats* stats,
+                                 Search search) {
+    if (stats == nullptr) {
+        search();
+        return;
+    }
+    long distances_before = graph.metric_distance_computations.load();
+    long hops_before = graph.metric_hops.load();
+    search();
+    stats->distance_computations += graph.metric_distance_computations.load() - distances_before;
+    stats->hops += graph.metric_hops.load() - hops_before;
+    stats->effective_ef = std::max(stats->effective_ef, std::max<size_t>(graph.ef_, k));
+}
+
+// 이웃 벡터를 미리 가져오는(prefetch) HNSW 검색
+// hnswlib searchKnn과 같은 순서로 탐색하되, 후보의 링크 목록과 다음 이웃의 벡터를 거리 계산 전에 prefetch해
+// 메모리 대기 시간을 거리 계산과 겹칩니다. 결과는 (거리, 라벨) 거리 오름차순입니다.
+// stats를 넘기면 같은 탐색의 레이어별 방문 수와 거리 계산 수를 기록합니다.
+inline std::vector<std::pair<float, hnswlib::labeltype>> search_with_prefetch(
+    hnswlib::HierarchicalNSW<float>& graph, const void* query, size_t k, TraversalStats* stats = nullptr) {
+    std::vector<std::pair<float, hnswlib::labeltype>> found;
+    if (graph.cur_element_count == 0) {
+        return found;
+    }
+
+    auto vector_of = [&graph](hnswlib::tableint id) {
+        return graph.data_level0_memory_ + id * graph.size_data_per_element_ + graph.offsetData_;
+    };
+    auto distance = [&](hnswlib::tableint id) {
+        if (stats) stats->distance_computations++;
+        return graph.fstdistfunc_(query, vector_of(id), graph.dist_func_param_);
+    };
+
+    // 상위 레이어: 탐욕적 하강
+    hnswlib::tableint current = graph.enterpoint_node_;
+    float current_dist = distance(current);
+    for (int level = graph.maxlevel_; level > 0; level--) {
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            hnswlib::linklistsizeint* links = graph.get_linklist(current, level);
+            int size = graph.getListCount(links);
+            hnswlib::tableint* neighbors = reinterpret_cast<hnswlib::tableint*>(links + 1);
+            if (size > 0) __builtin_prefetch(vector_of(neighbors[0]));
+            for (int i = 0; i < size; i++) {
+                if (i + 1 < size) __builtin_prefetch(vector_of(neighbors[i + 1]));
+                if (stats) stats->visit(level);
+                float d = distance(neighbors[i]);
+                if (d < current_dist) {
+                    current_dist = d;
+                    current = neighbors[i];
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    // 바닥 레이어: ef 크기의 후보 집합으로 탐색
+    // 방문 표시는 스레드별 태그 배열을 재사용 (검색마다 초기화하지 않고 태그 값만 증가)
+    thread_local std::vector<uint32_t> visit_tags;
+    thread_local uint32_t visit_tag = 0;
+    if (visit_tags.size() < graph.max_elements_) {
+        visit_tags.assign(graph.max_elements_, 0);
+        visit_tag = 0;
+    }
+    if (++visit_tag == 0) {
+        std::fill(visit_tags.begin(), visit_tags.end(), 0);
+        visit_tag = 1;
+    }
+
+    // 삭제 표시된 노드는 경유만 하고 결과 후보(top)에는 넣지 않음
+    size_t ef = std::max<size_t>(graph.ef_, k);
+    if (stats) stats->effective_ef = std::max(stats->effective_ef, ef);
+    using Candidate = std::pair<float, hnswlib::tableint>;
+    std::priority_queue<Candidate> top;                                                   // 거리 최대 힙
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> frontier; // 거리 최소 힙
+
+    visit_tags[current] = visit_tag;
+    if (stats) stats->visit(0);
+    if (!graph.isMarkedDeleted(current)) top.emplace(current_dist, current);
+    frontier.emplace(current_dist, current);
+    float lower_bound = top.empty() ? std::numeric_limits<float>::max() : current_dist;
+
+    while (!frontier.empty()) {
+        Candidate candidate = frontier.top();
+        if (candidate.first > lower_bound && top.size() >= ef) {
+            break;
+        }
+        frontier.pop();
+
+        hnswlib::linklistsizeint* links = graph.get_linklist0(candidate.second);
+        int size = graph.getListCount(links);
+        hnswlib::tableint* neighbors = reinterpret_cast<hnswlib::tableint*>(links + 1);
+        if (size > 0) {
+            __builtin_prefetch(&visit_tags[neighbors[0]]);
+            __builtin_prefetch(vector_of(neighbors[0]));
+        }
+        for (int i = 0; i < size; i++) {
+            hnswlib::tableint neighbor = neighbors[i];
+            if (i + 1 < size) {
+                __builtin_prefetch(&visit_tags[neighbors[i + 1]]);
+                __builtin_prefetch(vector_of(neighbors[i + 1]));
+            }
+            if (visit_tags[neighbor] == visit_tag) continue;
+            visit_tags[neighbor] = visit_tag;
+            if (stats) stats->visit(0);
+
+            float d = distance(neighbor);
+            if (top.size() < ef || d < lower_bound) {
+                frontier.emplace(d, neighbor);
+                // 다음에 꺼낼 후보의 링크 목록을 미리 가져옴
+                __builtin_prefetch(graph.get_linklist0(frontier.top().second));
+                if (!graph.isMarkedDeleted(neighbor)) top.emplace(d, neighbor);
+                if (top.size() > ef) top.pop();
+                if (!top.empty()) lower_bound = top.top().first;
+            }
+        }
+    }
+
+    // 상위 k개 (거리 오름차순)
+    while (!top.empty()) {
+        found.emplace_back(top.top().first, graph.getExternalLabel(top.top().second));
+        top.pop();
+    }
+    std::reverse(found.begin(), found.end());
+    if (found.size() > k) found.resize(k);
+    return found;
+}
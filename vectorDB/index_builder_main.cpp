@@ -0,0 +1,149 @@
+#include <chrono>
+
+// 오프라인 인덱스 빌더
+// 서빙 노드 대신 빌드 서버에서 임베딩과 HNSW 구성을 모든 코어로 수행하고, 완성된 데이터베이스 파일만 배포합니다.
+//
+// 사용법:
+//   build <입력 파일> <출력 경로> [--vectors] [--dim N] [--tokenizer 모델] [--model 가중치] [--reorder]
+//       텍스트 입력: 한 줄에 "텍스트" 또는 "텍스트<TAB>메타데이터"
+//       --vectors 입력: 한 줄에 {"text": ..., "metadata": ..., "embedding": [...]} (임베딩 계산 생략)
+//   merge <출력 경로> <세그먼트 경로>... [--reorder]
+//       저장된 세그먼트들을 재임베딩 없이 하나의 그래프로 병합
+
+namespace {
+
+struct BuilderOptions {
+    bool vectors = false;
+    bool reorder = false;
+    int dimension = 384;
+    std::string tokenizer_path;
+    std::string model_path;
+    std::vector<std::string> positional;
+};
+
+BuilderOptions parse_options(int argc, char* argv[]) {
+    BuilderOptions options;
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--vectors") {
+            options.vectors = true;
+        } else if (arg == "--reorder") {
+            options.reorder = true;
+        } else if (arg == "--dim" && i + 1 < argc) {
+            options.dimension = std::stoi(argv[++i]);
+        } else if (arg == "--tokenizer" && i + 1 < argc) {
+            options.tokenizer_path = argv[++i];
+        } else if (arg == "--model" && i + 1 < argc) {
+            options.model_path = argv[++i];
+        } else {
+            options.positional.push_back(arg);
+        }
+    }
+    return options;
+}
+
+int run_build(const BuilderOptions& options) {
+    if (options.positional.size() != 2) {
+        std::cerr << "build에는 입력 파일과 출력 경로가 필요합니다." << std::endl;
+        return 1;
+    }
+    std::ifstream input(options.positional[0]);
+    if (!input.is_open()) {
+        std::cerr << "입력 파일을 열 수 없습니다: " << options.positional[0] << std::endl;
+        return 1;
+    }
+
+    std::vector<std::string> texts;
+    std::vector<std::string> metadatas;
+    std::vector<std::vector<float>> embeddings;
+    std::string line;
+    while (std::getline(input, line)) {
+        if (line.empty()) continue;
+        if (options.vectors) {
+            json record = json::parse(line);
+            texts.push_back(record["text"].get<std::string>());
+            metadatas.push_back(record.value("metadata", ""));
+            embeddings.push_back(record["embedding"].get<std::vector<float>>());
+        } else {
+            size_t tab = line.find('\t');
+            texts.push_back(line.substr(0, tab));
+            metadatas.push_back(tab == std::string::npos ? "" : line.substr(tab + 1));
+        }
+    }
+
+    // 벡터 입력이면 차원은 파일에서 결정
+    int dimension = options.vectors && !embeddings.empty() ? static_cast<int>(embeddings[0].size()) : options.dimension;
+    VectorDB db(dimension, std::max<size_t>(1, texts.size()));
+    if (!options.tokenizer_path.empty() && !db.load_tokenizer(options.tokenizer_path)) {
+        return 1;
+    }
+    if (!options.model_path.empty() && !db.load_embedding_model(options.model_path)) {
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    if (options.vectors) {
+        db.add_embeddings_parallel(texts, metadatas, embeddings);
+    } else {
+        db.build_from_texts(texts, metadatas);
+    }
+    double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "인덱스 빌드 완료: " << texts.size() << "개, " << elapsed_ms << " ms" << std::endl;
+
+    db.set_reorder_on_save(options.reorder);
+    return db.save(options.positional[1]) ? 0 : 1;
+}
+
+int run_merge(const BuilderOptions& options) {
+    if (options.positional.size() < 2) {
+        std::cerr << "merge에는 출력 경로와 하나 이상의 세그먼트 경로가 필요합니다." << std::endl;
+        return 1;
+    }
+
+    // 세그먼트를 먼저 모두 로드해 전체 항목 수로 출력 인덱스 크기를 정함
+    std::vector<std::unique_ptr<VectorDB>> segments;
+    size_t total = 0;
+    for (size_t i = 1; i < options.positional.size(); i++) {
+        std::unique_ptr<VectorDB> segment(new VectorDB());
+        if (!segment->load(options.positional[i], false)) {
+            return 1;
+        }
+        total += segment->size();
+        segments.push_back(std::move(segment));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    VectorDB merged(segments[0]->get_dimension(), std::max<size_t>(1, total));
+    for (auto& segment : segments) {
+        merged.merge_segment(*segment);
+    }
+    double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << segments.size() << "개 세그먼트 병합 완료: " << merged.size() << "개, " << elapsed_ms << " ms" << std::endl;
+
+    merged.set_reorder_on_save(options.reorder);
+    return merged.save(options.positional[0]) ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "사용법: " << argv[0] << " build <입력 파일> <출력 경로> [--vectors] [--dim N] "
+                  << "[--tokenizer 모델] [--model 가중치] [--reorder]" << std::endl;
+        std::cerr << "       " << argv[0] << " merge <출력 경로> <세그먼트 경로>... [--reorder]" << std::endl;
+        return 1;
+    }
+
+    BuilderOptions options = parse_options(argc, argv);
+    std::string command = argv[1];
+    try {
+        if (command == "build") return run_build(options);
+        if (command == "merge") return run_merge(options);
+    } catch (const std::exception& e) {
+        std::cerr << "오류: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::cerr << "알 수 없는 명령: " << command << std::endl;
+    return 1;
+}
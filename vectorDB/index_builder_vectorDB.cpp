@@ -0,0 +1,77 @@
+public:
+    size_t get_dimension() const {
+        return vector_dimension;
+    }
+
+    // 미리 계산된 임베딩을 모든 코어로 병렬 삽입 (오프라인 빌드용)
+    // append_entry는 동시 호출이 안전하므로 HNSW 삽입이 스레드 수만큼 병렬로 진행됩니다.
+    // 스레드 스케줄에 따라 ID 순서가 입력 순서와 달라질 수 있습니다.
+    // 인덱스는 단위 벡터를 가정하므로 (COSINE = 내적) 입력 임베딩은 삽입 전에 정규화합니다.
+    void add_embeddings_parallel(const std::vector<std::string>& texts,
+                                 const std::vector<std::string>& metadatas,
+                                 const std::vector<std::vector<float>>& embeddings) {
+        if (embeddings.size() != texts.size() || (!metadatas.empty() && metadatas.size() != texts.size())) {
+            throw std::runtime_error("텍스트, 메타데이터, 임베딩의 개수가 일치해야 합니다.");
+        }
+        if (size() + texts.size() > max_elements) {
+            throw std::runtime_error("최대 저장 용량을 초과합니다.");
+        }
+        for (const auto& embedding : embeddings) {
+            if (embedding.size() != vector_dimension) {
+                throw std::runtime_error("임베딩 차원이 데이터베이스 차원과 다릅니다.");
+            }
+            float sum = 0.0f;
+            for (float v : embedding) {
+                sum += v * v;
+            }
+            if (!(sum > 0.0f) || !std::isfinite(sum)) {
+                throw std::runtime_error("정규화할 수 없는 임베딩이 있습니다 (0 벡터 또는 NaN/Inf).");
+            }
+        }
+
+        #pragma omp parallel for schedule(dynamic, 64)
+        for (size_t i = 0; i < texts.size(); i++) {
+            append_entry(texts[i], metadatas.empty() ? "" : metadatas[i], normalize_vector(embeddings[i]));
+        }
+    }
+
+    // 텍스트를 chunk_size개씩 병렬 임베딩한 뒤 병렬 삽입 (전체 임베딩을 한꺼번에 메모리에 두지 않음)
+    void build_from_texts(const std::vector<std::string>& texts,
+                          const std::vector<std::string>& metadatas = {},
+                          size_t chunk_size = 4096) {
+        if (!metadatas.empty() && metadatas.size() != texts.size()) {
+            throw std::runtime_error("텍스트와 메타데이터의 개수가 일치해야 합니다.");
+        }
+
+        for (size_t start = 0; start < texts.size(); start += chunk_size) {
+            size_t end = std::min(texts.size(), start + chunk_size);
+            std::vector<std::string> chunk(texts.begin() + start, texts.begin() + end);
+            std::vector<std::string> chunk_metadata;
+            if (!metadatas.empty()) {
+                chunk_metadata.assign(metadatas.begin() + start, metadatas.begin() + end);
+            }
+
+            add_embeddings_parallel(chunk, chunk_metadata, embed_texts(chunk));
+            std::cout << "빌드 진행: " << end << " / " << texts.size() << std::endl;
+        }
+    }
+
+    // 다른 세그먼트(샤드)의 항목을 재임베딩 없이 이 인덱스의 그래프에 병합
+    // 세그먼트의 벡터를 그대로 다시 삽입하므로 결과는 하나의 HNSW 그래프이며, 삭제된 항목은 빠집니다.
+    size_t merge_segment(VectorDB& segment) {
+        if (segment.vector_dimension != vector_dimension) {
+            throw std::runtime_error("세그먼트 차원이 데이터베이스 차원과 다릅니다.");
+        }
+
+        std::vector<std::string> texts;
+        std::vector<std::string> metadatas;
+        std::vector<std::vector<float>> embeddings;
+        segment.for_each_entry([&](const std::string& text, const std::string& metadata, const float* vec) {
+            texts.push_back(text);
+            metadatas.push_back(metadata);
+            embeddings.emplace_back(vec, vec + vector_dimension);
+        });
+
+        add_embeddings_parallel(texts, metadatas, embeddings);
+        return texts.size();
+    }
@@ -5,8 +5,9 @@ int main() {
         
         std::cout << "== 라즈베리파이용 VectorDB 데모 ==" << std::endl;
         
-        // 분산 VectorDB 초기화
+        // 분산 VectorDB 초기화 (비동기 요청은 스레드 풀에서 배치로 묶어 처리)
         DistributedVectorDB db(128, 1000, 3);
+        db.enable_async(pool);
         
         // 샘플 텍스트 데이터
         std::vector<std::string> texts = {
@@ -32,13 +33,9 @@ int main() {
             "임베딩 기술의 원리는 무엇인가요?"
         };
         
-        // 비동기로 모든 쿼리 실행
+        // 비동기로 모든 쿼리 실행 (짧은 시간 안에 들어온 쿼리는 한 번의 배치로 병합됨)
         for (const auto& query : queries) {
-            futures.push_back(
-                pool.enqueue([&db, query]() {
-                    return db.search(query, 3, VectorDB::COSINE);
-                })
-            );
+            futures.push_back(db.search_async(query, 3, VectorDB::COSINE));
         }
         
         // 결과 수집 및 출력
@@ -0,0 +1,190 @@
+#include <cmath>
+#include <cstddef>
+#include <hnswlib/hnswlib.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// hnswlib 거리 공간 (L1, L2, 내적, 정규화 코사인)
+// shared_storage가 true면 그래프에는 벡터 대신 벡터 포인터(8바이트)만 저장하므로
+// 여러 지표의 그래프가 하나의 벡터 저장소를 함께 사용할 수 있습니다.
+// 이때 addPoint/searchKnn에는 벡터 주소가 아니라 "벡터 포인터의 주소"를 넘겨야 합니다.
+class MetricSpace : public hnswlib::SpaceInterface<float> {
+public:
+    enum Metric {
+        L1,
+        L2,            // 제곱 유클리드 거리
+        INNER_PRODUCT, // 1 - 내적 (hnswlib InnerProductSpace와 같은 값)
+        COSINE         // 1 - 코사인 유사도 (정규화되지 않은 벡터도 정확)
+    };
+
+    MetricSpace(size_t dim, Metric metric, bool shared_storage = false)
+        : dimension(dim), shared(shared_storage) {
+        switch (metric) {
+            case L1:            func = shared ? &indirect<l1_distance> : &direct<l1_distance>; break;
+            case L2:            func = shared ? &indirect<l2_distance> : &direct<l2_distance>; break;
+            case INNER_PRODUCT: func = shared ? &indirect<ip_distance> : &direct<ip_distance>; break;
+            default:            func = shared ? &indirect<cosine_distance> : &direct<cosine_distance>; break;
+        }
+    }
+
+    size_t get_data_size() override {
+        return shared ? sizeof(const float*) : dimension * sizeof(float);
+    }
+
+    hnswlib::DISTFUNC<float> get_dist_func() override {
+        return func;
+    }
+
+    void* get_dist_func_param() override {
+        return &dimension;
+    }
+
+    // ---- SIMD 커널 ----
+
+    static float l1_distance(const float* a, const float* b, size_t dim) {
+        size_t i = 0;
+        float sum = 0.0f;
+#if defined(__AVX2__)
+        const __m256 sign_mask = _mm256_set1_ps(-0.0f);
+        __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+        for (; i + 16 <= dim; i += 16) {
+            acc0 = _mm256_add_ps(acc0, _mm256_andnot_ps(sign_mask, _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i))));
+            acc1 = _mm256_add_ps(acc1, _mm256_andnot_ps(sign_mask, _mm256_sub_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8))));
+        }
+        sum = hsum(_mm256_add_ps(acc0, acc1));
+#elif defined(__ARM_NEON)
+        float32x4_t acc0 = vdupq_n_f32(0), acc1 = vdupq_n_f32(0);
+        for (; i + 8 <= dim; i += 8) {
+            acc0 = vaddq_f32(acc0, vabdq_f32(vld1q_f32(a + i), vld1q_f32(b + i)));
+            acc1 = vaddq_f32(acc1, vabdq_f32(vld1q_f32(a + i + 4), vld1q_f32(b + i + 4)));
+        }
+        sum = vaddvq_f32(vaddq_f32(acc0, acc1));
+#endif
+        for (; i < dim; i++) {
+            sum += std::fabs(a[i] - b[i]);
+        }
+        return sum;
+    }
+
+    static float l2_distance(const float* a, const float* b, size_t dim) {
+        size_t i = 0;
+        float sum = 0.0f;
+#if defined(__AVX2__) && defined(__FMA__)
+        __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+        for (; i + 16 <= dim; i += 16) {
+            __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+            __m256 d1 = _mm256_sub_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8));
+            acc0 = _mm256_fmadd_ps(d0, d0, acc0);
+            acc1 = _mm256_fmadd_ps(d1, d1, acc1);
+        }
+        sum = hsum(_mm256_add_ps(acc0, acc1));
+#elif defined(__ARM_NEON)
+        float32x4_t acc0 = vdupq_n_f32(0), acc1 = vdupq_n_f32(0);
+        for (; i + 8 <= dim; i += 8) {
+            float32x4_t d0 = vsubq_f32(vld1q_f32(a + i), vld1q_f32(b + i));
+            float32x4_t d1 = vsubq_f32(vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+            acc0 = vfmaq_f32(acc0, d0, d0);
+            acc1 = vfmaq_f32(acc1, d1, d1);
+        }
+        sum = vaddvq_f32(vaddq_f32(acc0, acc1));
+#endif
+        for (; i < dim; i++) {
+            float d = a[i] - b[i];
+            sum += d * d;
+        }
+        return sum;
+    }
+
+    static float ip_distance(const float* a, const float* b, size_t dim) {
+        return 1.0f - dot(a, b, dim);
+    }
+
+    // 내적과 두 노름을 한 번의 순회로 계산
+    static float cosine_distance(const float* a, const float* b, size_t dim) {
+        size_t i = 0;
+        float ab = 0.0f, aa = 0.0f, bb = 0.0f;
+#if defined(__AVX2__) && defined(__FMA__)
+        __m256 vab = _mm256_setzero_ps(), vaa = _mm256_setzero_ps(), vbb = _mm256_setzero_ps();
+        for (; i + 8 <= dim; i += 8) {
+            __m256 va = _mm256_loadu_ps(a + i);
+            __m256 vb = _mm256_loadu_ps(b + i);
+            vab = _mm256_fmadd_ps(va, vb, vab);
+            vaa = _mm256_fmadd_ps(va, va, vaa);
+            vbb = _mm256_fmadd_ps(vb, vb, vbb);
+        }
+        ab = hsum(vab); aa = hsum(vaa); bb = hsum(vbb);
+#elif defined(__ARM_NEON)
+        float32x4_t vab = vdupq_n_f32(0), vaa = vdupq_n_f32(0), vbb = vdupq_n_f32(0);
+        for (; i + 4 <= dim; i += 4) {
+            float32x4_t va = vld1q_f32(a + i);
+            float32x4_t vb = vld1q_f32(b + i);
+            vab = vfmaq_f32(vab, va, vb);
+            vaa = vfmaq_f32(vaa, va, va);
+            vbb = vfmaq_f32(vbb, vb, vb);
+        }
+        ab = vaddvq_f32(vab); aa = vaddvq_f32(vaa); bb = vaddvq_f32(vbb);
+#endif
+        for (; i < dim; i++) {
+            ab += a[i] * b[i];
+            aa += a[i] * a[i];
+            bb += b[i] * b[i];
+        }
+        float denominator = std::sqrt(aa * bb);
+        return denominator > 0.0f ? 1.0f - ab / denominator : 1.0f;
+    }
+
+private:
+    size_t dimension;
+    bool shared;
+    hnswlib::DISTFUNC<float> func;
+
+    static float dot(const float* a, const float* b, size_t dim) {
+        size_t i = 0;
+        float sum = 0.0f;
+#if defined(__AVX2__) && defined(__FMA__)
+        __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+        for (; i + 16 <= dim; i += 16) {
+            acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+            acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+        }
+        sum = hsum(_mm256_add_ps(acc0, acc1));
+#elif defined(__ARM_NEON)
+        float32x4_t acc0 = vdupq_n_f32(0), acc1 = vdupq_n_f32(0);
+        for (; i + 8 <= dim; i += 8) {
+            acc0 = vfmaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+            acc1 = vfmaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+        }
+        sum = vaddvq_f32(vaddq_f32(acc0, acc1));
+#endif
+        for (; i < dim; i++) {
+            sum += a[i] * b[i];
+        }
+        return sum;
+    }
+
+#if defined(__AVX2__)
+    static float hsum(__m256 v) {
+        __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+        s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+        s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+        return _mm_cvtss_f32(s);
+    }
+#endif
+
+    template<float (*Kernel)(const float*, const float*, size_t)>
+    static float direct(const void* a, const void* b, const void* param) {
+        return Kernel(static_cast<const float*>(a), static_cast<const float*>(b),
+                      *static_cast<const size_t*>(param));
+    }
+
+    // 저장된 값이 벡터 포인터인 경우
+    template<float (*Kernel)(const float*, const float*, size_t)>
+    static float indirect(const void* a, const void* b, const void* param) {
+        return Kernel(*static_cast<const float* const*>(a), *static_cast<const float* const*>(b),
+                      *static_cast<const size_t*>(param));
+    }
+};
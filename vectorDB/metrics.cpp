@@ -0,0 +1,246 @@
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <chrono>
+#include <sstream>
+#include <functional>
+#include <algorithm>
+#include <cstdint>
+
+// 연산별 지연 시간 히스토그램과 카운터
+// 기록은 스레드마다 따로 둔 셀에 잠금 없이 (단일 기록자이므로 원자적 load/store만으로) 하고,
+// 스냅샷이나 Prometheus 텍스트를 만들 때만 모든 스레드의 셀을 합칩니다.
+// 히스토그램은 HDR 방식(2의 거듭제곱 구간을 8개로 나눈 로그-선형 버킷, 상대 오차 12.5% 이하)으로 나노초를 기록합니다.
+class MetricsRegistry {
+public:
+    struct HistogramSnapshot {
+        std::string name;
+        uint64_t count = 0;
+        double sum_us = 0;
+        double mean_us = 0;
+        double p50_us = 0;
+        double p90_us = 0;
+        double p99_us = 0;
+        double p999_us = 0;
+        double max_us = 0;
+        std::vector<uint64_t> buckets; // HDR 버킷별 건수
+    };
+
+    struct Snapshot {
+        std::vector<HistogramSnapshot> histograms;
+        std::vector<std::pair<std::string, uint64_t>> counters;
+        std::vector<std::pair<std::string, double>> gauges;
+    };
+
+    // 연산 시간 측정 (소멸 시 기록)
+    class Timer {
+    public:
+        Timer(MetricsRegistry& metrics, int histogram)
+            : registry(metrics), id(histogram), start(std::chrono::steady_clock::now()) {}
+        ~Timer() {
+            registry.record(id, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count()));
+        }
+    private:
+        MetricsRegistry& registry;
+        int id;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    MetricsRegistry(std::vector<std::string> histogram_names, std::vector<std::string> counter_names)
+        : histograms(std::move(histogram_names)), counters(std::move(counter_names)),
+          registry_id(next_registry_id()) {}
+
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    void record(int histogram, uint64_t nanoseconds) {
+        std::atomic<uint64_t>* cell = local_cells() + histogram * histogram_stride;
+        bump(cell[bucket_index(nanoseconds)], 1);
+        bump(cell[bucket_count], 1);
+        bump(cell[bucket_count + 1], nanoseconds);
+        if (cell[bucket_count + 2].load(std::memory_order_relaxed) < nanoseconds) {
+            cell[bucket_count + 2].store(nanoseconds, std::memory_order_relaxed);
+        }
+    }
+
+    void add(int counter, uint64_t value = 1) {
+        bump(local_cells()[histograms.size() * histogram_stride + counter], value);
+    }
+
+    // 조회 시점에 값을 읽는 게이지 (큐 깊이, 항목 수 등)
+    void add_gauge(const std::string& name, std::function<double()> read) {
+        std::lock_guard<std::mutex> lock(cells_mutex);
+        gauges.emplace_back(name, std::move(read));
+    }
+
+    Snapshot snapshot() {
+        Snapshot result;
+        std::vector<uint64_t> totals(cell_count(), 0);
+        std::vector<uint64_t> maxima(histograms.size(), 0);
+        {
+            std::lock_guard<std::mutex> lock(cells_mutex);
+            for (const auto& cells : thread_cells) {
+                for (size_t i = 0; i < totals.size(); i++) {
+                    totals[i] += cells[i].load(std::memory_order_relaxed);
+                }
+                for (size_t h = 0; h < histograms.size(); h++) {
+                    maxima[h] = std::max(maxima[h], cells[h * histogram_stride + bucket_count + 2].load(std::memory_order_relaxed));
+                }
+            }
+            for (const auto& gauge : gauges) {
+                result.gauges.emplace_back(gauge.first, gauge.second());
+            }
+        }
+
+        for (size_t h = 0; h < histograms.size(); h++) {
+            const uint64_t* cell = totals.data() + h * histogram_stride;
+            HistogramSnapshot histogram;
+            histogram.name = histograms[h];
+            histogram.buckets.assign(cell, cell + bucket_count);
+            histogram.count = cell[bucket_count];
+            histogram.sum_us = cell[bucket_count + 1] / 1000.0;
+            histogram.mean_us = histogram.count ? histogram.sum_us / histogram.count : 0.0;
+            // 버킷 상한은 실제 최댓값보다 클 수 있으므로 최댓값으로 제한
+            histogram.max_us = maxima[h] / 1000.0;
+            histogram.p50_us = std::min(histogram.max_us, percentile(histogram, 0.50));
+            histogram.p90_us = std::min(histogram.max_us, percentile(histogram, 0.90));
+            histogram.p99_us = std::min(histogram.max_us, percentile(histogram, 0.99));
+            histogram.p999_us = std::min(histogram.max_us, percentile(histogram, 0.999));
+            result.histograms.push_back(std::move(histogram));
+        }
+        for (size_t c = 0; c < counters.size(); c++) {
+            result.counters.emplace_back(counters[c], totals[histograms.size() * histogram_stride + c]);
+        }
+        return result;
+    }
+
+    // Prometheus 텍스트 형식
+    // 같은 이름의 지표가 여러 레지스트리(예: 샤드별)에 있으면 레이블로 구분해 한 묶음으로 출력합니다.
+    // sources: (스냅샷, 레이블 문자열) 목록, 레이블 예: shard="0"
+    static std::string prometheus_text(const std::string& prefix,
+                                       const std::vector<std::pair<Snapshot, std::string>>& sources) {
+        static const double bounds_s[] = {0.00001, 0.000025, 0.00005, 0.0001, 0.00025, 0.0005, 0.001, 0.0025,
+                                          0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10};
+        std::ostringstream out;
+        if (sources.empty()) return out.str();
+        const Snapshot& first = sources[0].first;
+
+        for (size_t h = 0; h < first.histograms.size(); h++) {
+            std::string name = prefix + first.histograms[h].name + "_seconds";
+            out << "# TYPE " << name << " histogram\n";
+            for (const auto& source : sources) {
+                const HistogramSnapshot& histogram = source.first.histograms[h];
+                std::string sep = source.second.empty() ? "" : ",";
+                uint64_t cumulative = 0;
+                size_t b = 0;
+                for (double bound : bounds_s) {
+                    // 상한이 경계 이하인 HDR 버킷을 누적 (근사)
+                    while (b < histogram.buckets.size() && bucket_upper(b) <= bound * 1e9) {
+                        cumulative += histogram.buckets[b++];
+                    }
+                    out << name << "_bucket{" << source.second << sep << "le=\"" << bound << "\"} " << cumulative << "\n";
+                }
+                out << name << "_bucket{" << source.second << sep << "le=\"+Inf\"} " << histogram.count << "\n";
+                out << name << "_sum" << braces(source.second) << " " << histogram.sum_us / 1e6 << "\n";
+                out << name << "_count" << braces(source.second) << " " << histogram.count << "\n";
+            }
+        }
+        for (size_t c = 0; c < first.counters.size(); c++) {
+            std::string name = prefix + first.counters[c].first + "_total";
+            out << "# TYPE " << name << " counter\n";
+            for (const auto& source : sources) {
+                out << name << braces(source.second) << " " << source.first.counters[c].second << "\n";
+            }
+        }
+        for (size_t g = 0; g < first.gauges.size(); g++) {
+            std::string name = prefix + first.gauges[g].first;
+            out << "# TYPE " << name << " gauge\n";
+            // 게이지는 레지스트리마다 등록 여부가 다를 수 있으므로 이름으로 찾음
+            for (const auto& source : sources) {
+                for (const auto& gauge : source.first.gauges) {
+                    if (gauge.first == first.gauges[g].first) {
+                        out << name << braces(source.second) << " " << gauge.second << "\n";
+                    }
+                }
+            }
+        }
+        return out.str();
+    }
+
+private:
+    static const int sub_bucket_bits = 3;
+    static const size_t sub_buckets = 1 << sub_bucket_bits;
+    static const size_t bucket_count = 320;                 // 약 2^40ns(18분)까지
+    static const size_t histogram_stride = bucket_count + 3; // 버킷 + 건수 + 합계 + 최댓값
+
+    std::vector<std::string> histograms;
+    std::vector<std::string> counters;
+    std::vector<std::pair<std::string, std::function<double()>>> gauges;
+    uint64_t registry_id;
+
+    // 스레드별 셀 (스레드가 끝나도 값이 남도록 레지스트리가 소유)
+    std::mutex cells_mutex;
+    std::vector<std::unique_ptr<std::atomic<uint64_t>[]>> thread_cells;
+
+    static uint64_t next_registry_id() {
+        static std::atomic<uint64_t> next{1};
+        return next++;
+    }
+
+    size_t cell_count() const {
+        return histograms.size() * histogram_stride + counters.size();
+    }
+
+    // 단일 기록자이므로 잠금 접두사가 붙는 fetch_add 대신 load/store
+    static void bump(std::atomic<uint64_t>& cell, uint64_t value) {
+        cell.store(cell.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t>* local_cells() {
+        // 스레드가 쓰는 레지스트리별 셀 (레지스트리 ID는 재사용되지 않으므로 소멸된 레지스트리와 섞이지 않음)
+        thread_local std::vector<std::pair<uint64_t, std::atomic<uint64_t>*>> owned;
+        for (const auto& entry : owned) {
+            if (entry.first == registry_id) return entry.second;
+        }
+
+        std::lock_guard<std::mutex> lock(cells_mutex);
+        std::unique_ptr<std::atomic<uint64_t>[]> cells(new std::atomic<uint64_t>[cell_count()]());
+        std::atomic<uint64_t>* raw = cells.get();
+        thread_cells.push_back(std::move(cells));
+        owned.emplace_back(registry_id, raw);
+        return raw;
+    }
+
+    static size_t bucket_index(uint64_t value) {
+        if (value < sub_buckets) return value;
+        int exponent = 63 - __builtin_clzll(value);
+        size_t sub = (value >> (exponent - sub_bucket_bits)) & (sub_buckets - 1);
+        return std::min(bucket_count - 1, (exponent - sub_bucket_bits + 1) * sub_buckets + sub);
+    }
+
+    // 버킷에 들어가는 가장 큰 값 (나노초)
+    static double bucket_upper(size_t index) {
+        if (index < sub_buckets) return static_cast<double>(index);
+        int exponent = static_cast<int>(index / sub_buckets) + sub_bucket_bits - 1;
+        uint64_t width = 1ULL << (exponent - sub_bucket_bits);
+        return static_cast<double>((sub_buckets + index % sub_buckets) * width + width - 1);
+    }
+
+    static double percentile(const HistogramSnapshot& histogram, double p) {
+        if (histogram.count == 0) return 0.0;
+        uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(histogram.count * p + 0.5));
+        uint64_t seen = 0;
+        for (size_t b = 0; b < histogram.buckets.size(); b++) {
+            seen += histogram.buckets[b];
+            if (seen >= target) return bucket_upper(b) / 1000.0;
+        }
+        return bucket_upper(bucket_count - 1) / 1000.0;
+    }
+
+    static std::string braces(const std::string& labels) {
+        return labels.empty() ? "" : "{" + labels + "}";
+    }
+};
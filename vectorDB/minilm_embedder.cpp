@@ -0,0 +1,498 @@
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// CPU 문장 임베딩 엔진 (MiniLM 계열 BERT/XLM-R 인코더)
+// - 가중치는 export_minilm.py로 만든 로컬 파일에서 로드합니다.
+// - 선형 계층은 fp32 또는 int8(행별 스케일) GEMM을 사용하며 AVX2/NEON 커널이 있습니다.
+// - 배치 입력은 패딩 없이 모든 토큰을 한 행렬로 이어 붙여(packed) 처리하고,
+//   어텐션은 점수 행렬을 만들지 않고 온라인 소프트맥스로 V까지 한 번에 계산합니다.
+// - 출력은 토큰 평균 풀링 후 L2 정규화된 벡터입니다.
+// - 입력은 SentencePiece ID이며 모델 어휘 ID = SentencePiece ID + token_id_offset 입니다.
+//   SentencePiece의 unk(sp_unk_id)는 오프셋을 더하지 않고 모델의 unk_id로 바꿉니다 (fairseq 규칙).
+//   이전 형식 "MINILM01"은 sp_unk_id, unk_id, layer_norm_eps가 없으며 unk 변환 없이 eps 1e-12를 사용합니다.
+//
+// 가중치 파일 형식 (리틀 엔디언):
+//   "MINILM02"
+//   int32 vocab_size, hidden, layers, heads, intermediate, max_positions, quantized
+//   int32 cls_id, sep_id, token_id_offset, position_offset, sp_unk_id, unk_id
+//   float32 layer_norm_eps
+//   단어 임베딩 [vocab, hidden]      (quantized면 int8 행렬 + 행별 스케일)
+//   위치 임베딩 [max_positions, hidden], 토큰 타입 임베딩 [hidden], 임베딩 LayerNorm γ/β
+//   레이어마다: Q, K, V, 출력, FFN 입력, FFN 출력 선형 계층과 두 LayerNorm γ/β
+//   선형 계층은 [out, in] 가중치 (quantized면 int8 + 행별 스케일) 뒤에 bias [out]
+class MiniLMEmbedder {
+public:
+    explicit MiniLMEmbedder(const std::string& weights_path) {
+        std::ifstream file(weights_path, std::ios::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error("임베딩 모델 파일을 열 수 없습니다: " + weights_path);
+        }
+
+        char magic[8];
+        file.read(magic, 8);
+        bool legacy = file && std::memcmp(magic, "MINILM01", 8) == 0;
+        if (!file || (!legacy && std::memcmp(magic, "MINILM02", 8) != 0)) {
+            throw std::runtime_error("임베딩 모델 파일 형식이 올바르지 않습니다: " + weights_path);
+        }
+
+        int32_t header[13] = {};
+        file.read(reinterpret_cast<char*>(header), (legacy ? 11 : 13) * sizeof(int32_t));
+        vocab_size = header[0];
+        hidden = header[1];
+        num_layers = header[2];
+        num_heads = header[3];
+        intermediate = header[4];
+        max_positions = header[5];
+        quantized = header[6] != 0;
+        cls_id = header[7];
+        sep_id = header[8];
+        token_id_offset = header[9];
+        position_offset = header[10];
+        sp_unk_id = legacy ? -1 : header[11];
+        unk_id = header[12];
+        layer_norm_eps = 1e-12f;
+        if (!legacy) {
+            file.read(reinterpret_cast<char*>(&layer_norm_eps), sizeof(layer_norm_eps));
+        }
+
+        if (hidden <= 0 || num_heads <= 0 || hidden % num_heads != 0 || num_layers <= 0) {
+            throw std::runtime_error("임베딩 모델 설정이 올바르지 않습니다.");
+        }
+        head_dim = hidden / num_heads;
+
+        word_embeddings = read_matrix(file, vocab_size, hidden);
+        position_embeddings = read_floats(file, static_cast<size_t>(max_positions) * hidden);
+        token_type_embedding = read_floats(file, hidden);
+        embedding_ln_gamma = read_floats(file, hidden);
+        embedding_ln_beta = read_floats(file, hidden);
+
+        layers.resize(num_layers);
+        for (auto& layer : layers) {
+            Linear q = read_linear(file, hidden, hidden);
+            Linear k = read_linear(file, hidden, hidden);
+            Linear v = read_linear(file, hidden, hidden);
+            layer.qkv = fuse_linears(q, k, v); // Q/K/V를 한 번의 GEMM으로
+            layer.attention_out = read_linear(file, hidden, hidden);
+            layer.ln1_gamma = read_floats(file, hidden);
+            layer.ln1_beta = read_floats(file, hidden);
+            layer.ffn_in = read_linear(file, hidden, intermediate);
+            layer.ffn_out = read_linear(file, intermediate, hidden);
+            layer.ln2_gamma = read_floats(file, hidden);
+            layer.ln2_beta = read_floats(file, hidden);
+        }
+
+        if (!file) {
+            throw std::runtime_error("임베딩 모델 파일이 잘렸습니다: " + weights_path);
+        }
+    }
+
+    int dimension() const { return hidden; }
+
+    // 토크나이저 ID 한 문장을 임베딩
+    std::vector<float> embed(const std::vector<int>& token_ids) const {
+        return embed_batch({token_ids})[0];
+    }
+
+    // 가변 길이 문장 배치를 임베딩 (패딩 없이 토큰을 이어 붙여 처리)
+    std::vector<std::vector<float>> embed_batch(const std::vector<std::vector<int>>& batch) const {
+        // 시퀀스 구성: [CLS] 토큰... [SEP], 최대 위치 수에 맞춰 자름
+        std::vector<int> offsets(batch.size() + 1, 0);
+        std::vector<int> ids;
+        std::vector<int> positions;
+        int max_tokens = std::max(2, max_positions - position_offset);
+        for (size_t b = 0; b < batch.size(); b++) {
+            int body = std::min<int>(static_cast<int>(batch[b].size()), max_tokens - 2);
+            ids.push_back(cls_id);
+            for (int i = 0; i < body; i++) {
+                int id = batch[b][i];
+                ids.push_back(id == sp_unk_id ? unk_id : id + token_id_offset);
+            }
+            ids.push_back(sep_id);
+            for (int p = 0; p < body + 2; p++) {
+                positions.push_back(p + position_offset);
+            }
+            offsets[b + 1] = static_cast<int>(ids.size());
+        }
+
+        const int tokens = static_cast<int>(ids.size());
+        std::vector<float> x(static_cast<size_t>(tokens) * hidden);
+        std::vector<float> qkv(static_cast<size_t>(tokens) * hidden * 3);
+        std::vector<float> context(static_cast<size_t>(tokens) * hidden);
+        std::vector<float> projected(static_cast<size_t>(tokens) * hidden);
+        std::vector<float> ffn(static_cast<size_t>(tokens) * intermediate);
+        std::vector<int8_t> quantized_input;
+        std::vector<float> input_scales;
+
+        // 임베딩 합 + LayerNorm
+        for (int t = 0; t < tokens; t++) {
+            float* row = &x[static_cast<size_t>(t) * hidden];
+            int id = std::min(std::max(ids[t], 0), vocab_size - 1);
+            word_embeddings.row(id, row);
+            const float* pos = &position_embeddings[static_cast<size_t>(std::min(positions[t], max_positions - 1)) * hidden];
+            for (int j = 0; j < hidden; j++) {
+                row[j] += pos[j] + token_type_embedding[j];
+            }
+        }
+        layer_norm(x.data(), tokens, hidden, embedding_ln_gamma.data(), embedding_ln_beta.data());
+
+        for (const auto& layer : layers) {
+            // 셀프 어텐션
+            linear(layer.qkv, x.data(), tokens, qkv.data(), quantized_input, input_scales);
+            attention(qkv.data(), offsets, context.data());
+            linear(layer.attention_out, context.data(), tokens, projected.data(), quantized_input, input_scales);
+            add_in_place(x.data(), projected.data(), static_cast<size_t>(tokens) * hidden);
+            layer_norm(x.data(), tokens, hidden, layer.ln1_gamma.data(), layer.ln1_beta.data());
+
+            // 피드포워드
+            linear(layer.ffn_in, x.data(), tokens, ffn.data(), quantized_input, input_scales);
+            gelu_in_place(ffn.data(), static_cast<size_t>(tokens) * intermediate);
+            linear(layer.ffn_out, ffn.data(), tokens, projected.data(), quantized_input, input_scales);
+            add_in_place(x.data(), projected.data(), static_cast<size_t>(tokens) * hidden);
+            layer_norm(x.data(), tokens, hidden, layer.ln2_gamma.data(), layer.ln2_beta.data());
+        }
+
+        // 평균 풀링 + L2 정규화
+        std::vector<std::vector<float>> embeddings(batch.size(), std::vector<float>(hidden, 0.0f));
+        for (size_t b = 0; b < batch.size(); b++) {
+            std::vector<float>& out = embeddings[b];
+            int count = offsets[b + 1] - offsets[b];
+            for (int t = offsets[b]; t < offsets[b + 1]; t++) {
+                const float* row = &x[static_cast<size_t>(t) * hidden];
+                for (int j = 0; j < hidden; j++) {
+                    out[j] += row[j];
+                }
+            }
+            float norm = 0.0f;
+            for (int j = 0; j < hidden; j++) {
+                out[j] /= count;
+                norm += out[j] * out[j];
+            }
+            norm = std::sqrt(norm);
+            if (norm > 0.0f) {
+                for (int j = 0; j < hidden; j++) {
+                    out[j] /= norm;
+                }
+            }
+        }
+        return embeddings;
+    }
+
+private:
+    // fp32 또는 int8(행별 스케일) 행렬
+    struct Matrix {
+        int rows = 0;
+        int cols = 0;
+        std::vector<float> values;   // fp32
+        std::vector<int8_t> qvalues; // int8
+        std::vector<float> scales;   // 행별 스케일 (int8)
+
+        bool is_quantized() const { return !qvalues.empty(); }
+
+        void row(int r, float* out) const {
+            if (is_quantized()) {
+                const int8_t* src = &qvalues[static_cast<size_t>(r) * cols];
+                for (int j = 0; j < cols; j++) out[j] = src[j] * scales[r];
+            } else {
+                std::memcpy(out, &values[static_cast<size_t>(r) * cols], cols * sizeof(float));
+            }
+        }
+    };
+
+    // y = x W^T + b, W는 [out, in]
+    struct Linear {
+        Matrix weight;
+        std::vector<float> bias;
+    };
+
+    struct Layer {
+        Linear qkv;
+        Linear attention_out;
+        Linear ffn_in;
+        Linear ffn_out;
+        std::vector<float> ln1_gamma, ln1_beta;
+        std::vector<float> ln2_gamma, ln2_beta;
+    };
+
+    int vocab_size, hidden, num_layers, num_heads, head_dim, intermediate, max_positions;
+    bool quantized;
+    int cls_id, sep_id, token_id_offset, position_offset, sp_unk_id, unk_id;
+    float layer_norm_eps;
+
+    Matrix word_embeddings;
+    std::vector<float> position_embeddings;
+    std::vector<float> token_type_embedding;
+    std::vector<float> embedding_ln_gamma, embedding_ln_beta;
+    std::vector<Layer> layers;
+
+    // ---- 로드 ----
+
+    static std::vector<float> read_floats(std::ifstream& file, size_t count) {
+        std::vector<float> values(count);
+        file.read(reinterpret_cast<char*>(values.data()), count * sizeof(float));
+        return values;
+    }
+
+    Matrix read_matrix(std::ifstream& file, int rows, int cols) const {
+        Matrix m;
+        m.rows = rows;
+        m.cols = cols;
+        size_t count = static_cast<size_t>(rows) * cols;
+        if (quantized) {
+            m.scales = read_floats(file, rows);
+            m.qvalues.resize(count);
+            file.read(reinterpret_cast<char*>(m.qvalues.data()), count);
+        } else {
+            m.values = read_floats(file, count);
+        }
+        return m;
+    }
+
+    Linear read_linear(std::ifstream& file, int in, int out) const {
+        Linear l;
+        l.weight = read_matrix(file, out, in);
+        l.bias = read_floats(file, out);
+        return l;
+    }
+
+    static Linear fuse_linears(const Linear& a, const Linear& b, const Linear& c) {
+        Linear fused;
+        fused.weight.rows = a.weight.rows + b.weight.rows + c.weight.rows;
+        fused.weight.cols = a.weight.cols;
+        for (const Linear* part : {&a, &b, &c}) {
+            const Matrix& w = part->weight;
+            fused.weight.values.insert(fused.weight.values.end(), w.values.begin(), w.values.end());
+            fused.weight.qvalues.insert(fused.weight.qvalues.end(), w.qvalues.begin(), w.qvalues.end());
+            fused.weight.scales.insert(fused.weight.scales.end(), w.scales.begin(), w.scales.end());
+            fused.bias.insert(fused.bias.end(), part->bias.begin(), part->bias.end());
+        }
+        return fused;
+    }
+
+    // ---- 커널 ----
+
+    // fp32 내적 4개를 동시에 계산 (x는 한 번만 읽음)
+    static void dot4_f32(const float* x, const float* w0, const float* w1, const float* w2, const float* w3,
+                         int k, float* out) {
+        int i = 0;
+        float s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+#if defined(__AVX2__) && defined(__FMA__)
+        __m256 a0 = _mm256_setzero_ps(), a1 = _mm256_setzero_ps();
+        __m256 a2 = _mm256_setzero_ps(), a3 = _mm256_setzero_ps();
+        for (; i + 8 <= k; i += 8) {
+            __m256 xv = _mm256_loadu_ps(x + i);
+            a0 = _mm256_fmadd_ps(xv, _mm256_loadu_ps(w0 + i), a0);
+            a1 = _mm256_fmadd_ps(xv, _mm256_loadu_ps(w1 + i), a1);
+            a2 = _mm256_fmadd_ps(xv, _mm256_loadu_ps(w2 + i), a2);
+            a3 = _mm256_fmadd_ps(xv, _mm256_loadu_ps(w3 + i), a3);
+        }
+        s0 = hsum256(a0); s1 = hsum256(a1); s2 = hsum256(a2); s3 = hsum256(a3);
+#elif defined(__ARM_NEON)
+        float32x4_t a0 = vdupq_n_f32(0), a1 = vdupq_n_f32(0), a2 = vdupq_n_f32(0), a3 = vdupq_n_f32(0);
+        for (; i + 4 <= k; i += 4) {
+            float32x4_t xv = vld1q_f32(x + i);
+            a0 = vfmaq_f32(a0, xv, vld1q_f32(w0 + i));
+            a1 = vfmaq_f32(a1, xv, vld1q_f32(w1 + i));
+            a2 = vfmaq_f32(a2, xv, vld1q_f32(w2 + i));
+            a3 = vfmaq_f32(a3, xv, vld1q_f32(w3 + i));
+        }
+        s0 = vaddvq_f32(a0); s1 = vaddvq_f32(a1); s2 = vaddvq_f32(a2); s3 = vaddvq_f32(a3);
+#endif
+        for (; i < k; i++) {
+            s0 += x[i] * w0[i]; s1 += x[i] * w1[i]; s2 += x[i] * w2[i]; s3 += x[i] * w3[i];
+        }
+        out[0] = s0; out[1] = s1; out[2] = s2; out[3] = s3;
+    }
+
+    // int8 내적 4개를 동시에 계산 (int32 누적)
+    static void dot4_i8(const int8_t* x, const int8_t* w0, const int8_t* w1, const int8_t* w2, const int8_t* w3,
+                        int k, int32_t* out) {
+        int i = 0;
+        int32_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+#if defined(__AVX2__)
+        __m256i a0 = _mm256_setzero_si256(), a1 = _mm256_setzero_si256();
+        __m256i a2 = _mm256_setzero_si256(), a3 = _mm256_setzero_si256();
+        for (; i + 16 <= k; i += 16) {
+            __m256i xv = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i)));
+            a0 = _mm256_add_epi32(a0, _mm256_madd_epi16(xv, _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(w0 + i)))));
+            a1 = _mm256_add_epi32(a1, _mm256_madd_epi16(xv, _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(w1 + i)))));
+            a2 = _mm256_add_epi32(a2, _mm256_madd_epi16(xv, _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(w2 + i)))));
+            a3 = _mm256_add_epi32(a3, _mm256_madd_epi16(xv, _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(w3 + i)))));
+        }
+        s0 = hsum256_epi32(a0); s1 = hsum256_epi32(a1); s2 = hsum256_epi32(a2); s3 = hsum256_epi32(a3);
+#elif defined(__ARM_NEON)
+        int32x4_t a0 = vdupq_n_s32(0), a1 = vdupq_n_s32(0), a2 = vdupq_n_s32(0), a3 = vdupq_n_s32(0);
+        for (; i + 16 <= k; i += 16) {
+            int8x16_t xv = vld1q_s8(x + i);
+#if defined(__ARM_FEATURE_DOTPROD)
+            a0 = vdotq_s32(a0, xv, vld1q_s8(w0 + i));
+            a1 = vdotq_s32(a1, xv, vld1q_s8(w1 + i));
+            a2 = vdotq_s32(a2, xv, vld1q_s8(w2 + i));
+            a3 = vdotq_s32(a3, xv, vld1q_s8(w3 + i));
+#else
+            int8x16_t v0 = vld1q_s8(w0 + i), v1 = vld1q_s8(w1 + i), v2 = vld1q_s8(w2 + i), v3 = vld1q_s8(w3 + i);
+            a0 = vpadalq_s16(a0, vmlal_high_s8(vmull_s8(vget_low_s8(xv), vget_low_s8(v0)), xv, v0));
+            a1 = vpadalq_s16(a1, vmlal_high_s8(vmull_s8(vget_low_s8(xv), vget_low_s8(v1)), xv, v1));
+            a2 = vpadalq_s16(a2, vmlal_high_s8(vmull_s8(vget_low_s8(xv), vget_low_s8(v2)), xv, v2));
+            a3 = vpadalq_s16(a3, vmlal_high_s8(vmull_s8(vget_low_s8(xv), vget_low_s8(v3)), xv, v3));
+#endif
+        }
+        s0 = vaddvq_s32(a0); s1 = vaddvq_s32(a1); s2 = vaddvq_s32(a2); s3 = vaddvq_s32(a3);
+#endif
+        for (; i < k; i++) {
+            s0 += x[i] * w0[i]; s1 += x[i] * w1[i]; s2 += x[i] * w2[i]; s3 += x[i] * w3[i];
+        }
+        out[0] = s0; out[1] = s1; out[2] = s2; out[3] = s3;
+    }
+
+#if defined(__AVX2__)
+    static float hsum256(__m256 v) {
+        __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+        s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+        s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+        return _mm_cvtss_f32(s);
+    }
+
+    static int32_t hsum256_epi32(__m256i v) {
+        __m128i s = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4E));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xB1));
+        return _mm_cvtsi128_si32(s);
+    }
+#endif
+
+    // y[m, n] = x[m, :] · W[n, :] + b[n]
+    // 가중치 4행 블록을 L1에 두고 모든 입력 행에 재사용하며, 출력 열 블록 단위로 병렬 처리
+    static void linear(const Linear& layer, const float* x, int m, float* y,
+                       std::vector<int8_t>& quantized_input, std::vector<float>& input_scales) {
+        const Matrix& w = layer.weight;
+        const int n = w.rows;
+        const int k = w.cols;
+        const int blocks = (n + 3) / 4;
+
+        if (w.is_quantized()) {
+            // 입력을 행별 대칭 int8로 동적 양자화
+            quantized_input.resize(static_cast<size_t>(m) * k);
+            input_scales.resize(m);
+            for (int r = 0; r < m; r++) {
+                const float* row = x + static_cast<size_t>(r) * k;
+                float max_abs = 0.0f;
+                for (int j = 0; j < k; j++) max_abs = std::max(max_abs, std::fabs(row[j]));
+                float scale = max_abs > 0.0f ? max_abs / 127.0f : 1.0f;
+                input_scales[r] = scale;
+                int8_t* qrow = &quantized_input[static_cast<size_t>(r) * k];
+                for (int j = 0; j < k; j++) {
+                    qrow[j] = static_cast<int8_t>(std::lround(row[j] / scale));
+                }
+            }
+
+            #pragma omp parallel for schedule(static)
+            for (int blk = 0; blk < blocks; blk++) {
+                int c = blk * 4;
+                const int8_t* wr[4];
+                for (int q = 0; q < 4; q++) {
+                    wr[q] = &w.qvalues[static_cast<size_t>(std::min(c + q, n - 1)) * k];
+                }
+                for (int r = 0; r < m; r++) {
+                    int32_t dots[4];
+                    dot4_i8(&quantized_input[static_cast<size_t>(r) * k], wr[0], wr[1], wr[2], wr[3], k, dots);
+                    for (int q = 0; q < 4 && c + q < n; q++) {
+                        y[static_cast<size_t>(r) * n + c + q] = dots[q] * input_scales[r] * w.scales[c + q] + layer.bias[c + q];
+                    }
+                }
+            }
+        } else {
+            #pragma omp parallel for schedule(static)
+            for (int blk = 0; blk < blocks; blk++) {
+                int c = blk * 4;
+                const float* wr[4];
+                for (int q = 0; q < 4; q++) {
+                    wr[q] = &w.values[static_cast<size_t>(std::min(c + q, n - 1)) * k];
+                }
+                for (int r = 0; r < m; r++) {
+                    float dots[4];
+                    dot4_f32(x + static_cast<size_t>(r) * k, wr[0], wr[1], wr[2], wr[3], k, dots);
+                    for (int q = 0; q < 4 && c + q < n; q++) {
+                        y[static_cast<size_t>(r) * n + c + q] = dots[q] + layer.bias[c + q];
+                    }
+                }
+            }
+        }
+    }
+
+    // 멀티헤드 어텐션 (qkv: [tokens, 3 * hidden], 시퀀스 경계는 offsets)
+    // 쿼리 행마다 온라인 소프트맥스로 최대값/합을 갱신하며 V를 바로 누적하므로 [L, L] 점수 행렬이 필요 없음
+    void attention(const float* qkv, const std::vector<int>& offsets, float* context) const {
+        const int stride = 3 * hidden;
+        const float scale = 1.0f / std::sqrt(static_cast<float>(head_dim));
+        const int sequences = static_cast<int>(offsets.size()) - 1;
+
+        #pragma omp parallel for collapse(2) schedule(dynamic)
+        for (int s = 0; s < sequences; s++) {
+            for (int h = 0; h < num_heads; h++) {
+                std::vector<float> acc(head_dim);
+                for (int i = offsets[s]; i < offsets[s + 1]; i++) {
+                    const float* q = qkv + static_cast<size_t>(i) * stride + h * head_dim;
+                    float running_max = -INFINITY;
+                    float running_sum = 0.0f;
+                    std::fill(acc.begin(), acc.end(), 0.0f);
+
+                    for (int j = offsets[s]; j < offsets[s + 1]; j++) {
+                        const float* key = qkv + static_cast<size_t>(j) * stride + hidden + h * head_dim;
+                        const float* value = qkv + static_cast<size_t>(j) * stride + 2 * hidden + h * head_dim;
+                        float score = 0.0f;
+                        for (int d = 0; d < head_dim; d++) score += q[d] * key[d];
+                        score *= scale;
+
+                        if (score > running_max) {
+                            float correction = std::exp(running_max - score);
+                            running_sum *= correction;
+                            for (int d = 0; d < head_dim; d++) acc[d] *= correction;
+                            running_max = score;
+                        }
+                        float p = std::exp(score - running_max);
+                        running_sum += p;
+                        for (int d = 0; d < head_dim; d++) acc[d] += p * value[d];
+                    }
+
+                    float* out = context + static_cast<size_t>(i) * hidden + h * head_dim;
+                    for (int d = 0; d < head_dim; d++) out[d] = acc[d] / running_sum;
+                }
+            }
+        }
+    }
+
+    void layer_norm(float* x, int rows, int cols, const float* gamma, const float* beta) const {
+        for (int r = 0; r < rows; r++) {
+            float* row = x + static_cast<size_t>(r) * cols;
+            float mean = 0.0f;
+            for (int j = 0; j < cols; j++) mean += row[j];
+            mean /= cols;
+            float var = 0.0f;
+            for (int j = 0; j < cols; j++) var += (row[j] - mean) * (row[j] - mean);
+            float inv_std = 1.0f / std::sqrt(var / cols + layer_norm_eps);
+            for (int j = 0; j < cols; j++) row[j] = (row[j] - mean) * inv_std * gamma[j] + beta[j];
+        }
+    }
+
+    static void add_in_place(float* x, const float* y, size_t count) {
+        for (size_t i = 0; i < count; i++) x[i] += y[i];
+    }
+
+    static void gelu_in_place(float* x, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            x[i] = 0.5f * x[i] * (1.0f + std::erf(x[i] * 0.70710678f));
+        }
+    }
+};
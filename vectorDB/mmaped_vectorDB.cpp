@@ -13,10 +13,11 @@ public:
         use_mmap = true;
         mmap_file = file_path;
         
-        // 메모리 매핑된 인덱스 생성
+        // 메모리 매핑된 인덱스 생성 (지표 그래프는 항목을 다시 추가하기 전에 폐기)
+        reset_metric_indexes();
         delete index;
         index = new hnswlib::HierarchicalNSW<float>(
-            hnswlib::InnerProductSpace(vector_dimension), 
+            index_space.get(), 
             max_elements, 
             16,   // M 파라미터
             200,  // ef_construction
@@ -27,6 +28,12 @@ public:
         
         // 기존 데이터 다시 추가 (필요한 경우)
         if (stored_texts.size() > 0) {
+            // 지연 로드된 항목도 모두 디코딩한 뒤 복사
+            for (size_t i = 0; i < stored_texts.size(); i++) {
+                materialize(i);
+            }
+            release_lazy_mapping();
+            
             std::vector<std::string> temp_texts = stored_texts;
             std::vector<std::string> temp_meta = stored_metadata;
             
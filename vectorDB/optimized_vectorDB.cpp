@@ -11,7 +11,7 @@ public:
         // 벡터를 다시 로드하여 양자화된 형태로 저장
         for (size_t i = 0; i < stored_texts.size(); i++) {
             // 기존 임베딩 가져오기
-            std::vector<float> embedding = embed_text(stored_texts[i]);
+            std::vector<float> embedding = embed_text(text_at(i));
             
             // 임베딩 양자화 (간단한 구현)
             if (bits == 8) {
@@ -58,6 +58,10 @@ public:
             }
         }
         
+        // 벡터가 바뀌었으므로 지표 그래프와 캐시된 검색 결과 무효화
+        reset_metric_indexes();
+        index_version++;
+        
         std::cout << "양자화 완료. 메모리 사용량이 감소했습니다." << std::endl;
     }
     
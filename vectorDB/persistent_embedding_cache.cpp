@@ -0,0 +1,241 @@
+#include <string>
+#include <vector>
+#include <atomic>
+#include <ctime>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// 디스크에 유지되는 임베딩 캐시 (텍스트 해시 -> 임베딩)
+// 하나의 파일을 MAP_SHARED로 매핑하므로 재시작 후에도 남아 있고, 같은 노드의 여러 VectorDB 프로세스가 함께 사용합니다.
+//
+// 파일 구성: 헤더(64바이트) + 버킷 bucket_count개 x 슬롯 slots_per_bucket개 (고정 크기)
+// 슬롯: key(8) check(8) checksum(4) 예약(4) 벡터(dim x 4)
+//   key 0: 비어 있음, 홀수: 기록 중 (상위 비트는 선점 시각, 초), 0이 아닌 짝수: 공개된 키 해시
+//
+// 읽기는 잠금 없이 key 확인 -> 복사 -> key 재확인 순서로 진행하고 (seqlock 방식),
+// 쓰기는 슬롯을 CAS로 선점한 뒤 내용을 기록하고 마지막에 key를 공개합니다.
+// 기록 중 프로세스가 죽으면 key가 공개되지 않으므로 읽히지 않으며, 전원 장애로 페이지 일부만
+// 디스크에 남은 슬롯은 checksum 불일치로 걸러냅니다. 버킷이 가득 차면 슬롯 하나를 덮어씁니다.
+class PersistentEmbeddingCache {
+public:
+    PersistentEmbeddingCache(const std::string& path, size_t dim, size_t capacity, size_t slots_per_bucket = 8)
+        : dimension(dim) {
+        if (capacity == 0 || slots_per_bucket == 0) {
+            throw std::runtime_error("임베딩 캐시 크기와 버킷당 슬롯 수는 1 이상이어야 합니다.");
+        }
+        int fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("임베딩 캐시 파일을 열 수 없습니다: " + path);
+        }
+
+        // 여러 프로세스가 동시에 처음 열 때 한 프로세스만 파일을 초기화하도록 잠금
+        flock(fd, LOCK_EX);
+        struct stat st;
+        Header header;
+        bool ok = fstat(fd, &st) == 0;
+        if (ok && st.st_size == 0) {
+            std::memset(&header, 0, sizeof(header));
+            std::memcpy(header.magic, "VDBEMB01", 8);
+            header.dimension = static_cast<uint32_t>(dim);
+            header.slots_per_bucket = static_cast<uint32_t>(slots_per_bucket);
+            header.bucket_count = (capacity + slots_per_bucket - 1) / slots_per_bucket;
+            // 슬롯 영역은 ftruncate로 0이 채워진 (희소) 영역
+            ok = ftruncate(fd, sizeof(Header) + header.bucket_count * slots_per_bucket * slot_bytes(dim)) == 0 &&
+                 pwrite(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header));
+        } else if (ok) {
+            // 손상된 헤더: 버킷/슬롯 수가 0이면 locate의 나머지 연산이, 너무 크면 크기 계산이 깨지므로
+            // 파일 크기에서 역산한 최대값과 먼저 비교
+            ok = pread(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header)) &&
+                 std::memcmp(header.magic, "VDBEMB01", 8) == 0 && header.dimension == dim &&
+                 header.bucket_count > 0 && header.slots_per_bucket > 0 &&
+                 static_cast<size_t>(st.st_size) >= sizeof(Header) &&
+                 header.bucket_count <= (static_cast<size_t>(st.st_size) - sizeof(Header)) /
+                     (header.slots_per_bucket * slot_bytes(dim));
+        }
+        flock(fd, LOCK_UN);
+        if (!ok) {
+            close(fd);
+            throw std::runtime_error("임베딩 캐시 파일 형식 또는 차원이 맞지 않습니다: " + path);
+        }
+
+        bucket_count = header.bucket_count;
+        slots = header.slots_per_bucket;
+        slot_size = slot_bytes(dim);
+        mapping_size = sizeof(Header) + bucket_count * slots * slot_size;
+        void* mapping = mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED) {
+            throw std::runtime_error("임베딩 캐시 파일을 매핑할 수 없습니다: " + path);
+        }
+        base = static_cast<char*>(mapping) + sizeof(Header);
+        mapped = mapping;
+    }
+
+    ~PersistentEmbeddingCache() {
+        munmap(mapped, mapping_size);
+    }
+
+    PersistentEmbeddingCache(const PersistentEmbeddingCache&) = delete;
+    PersistentEmbeddingCache& operator=(const PersistentEmbeddingCache&) = delete;
+
+    // source는 임베딩을 만든 모델/토크나이저 식별값 (다른 모델의 임베딩이 섞이지 않도록 키에 포함)
+    bool lookup(uint64_t source, const std::string& text, float* out) {
+        uint64_t key, check;
+        Slot* bucket = locate(source, text, key, check);
+
+        for (size_t s = 0; s < slots; s++) {
+            Slot* slot = slot_at(bucket, s);
+            if (__atomic_load_n(&slot->key, __ATOMIC_ACQUIRE) != key) continue;
+
+            uint64_t stored_check = slot->check;
+            uint32_t stored_checksum = slot->checksum;
+            std::memcpy(out, vector_of(slot), dimension * sizeof(float));
+
+            // 복사하는 동안 다른 프로세스가 슬롯을 덮어쓰지 않았는지 확인
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&slot->key, __ATOMIC_RELAXED) != key) continue;
+            if (stored_check != check || stored_checksum != checksum(check, out)) continue;
+
+            hit_count.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        miss_count.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // 이미 있거나 슬롯을 선점하지 못하면 기록하지 않음 (캐시이므로 실패해도 무방)
+    void insert(uint64_t source, const std::string& text, const float* vec) {
+        uint64_t key, check;
+        Slot* bucket = locate(source, text, key, check);
+
+        Slot* target = nullptr;
+        uint64_t claim = (static_cast<uint64_t>(std::time(nullptr)) << 1) | 1;
+        for (size_t s = 0; s < slots && target == nullptr; s++) {
+            Slot* slot = slot_at(bucket, s);
+            uint64_t current = __atomic_load_n(&slot->key, __ATOMIC_ACQUIRE);
+            if (current == key) return;
+            if (current == 0 || stale_claim(current, claim)) {
+                if (__atomic_compare_exchange_n(&slot->key, &current, claim, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+                    target = slot;
+                }
+            }
+        }
+        if (target == nullptr) {
+            // 버킷이 가득 참: 키에 따라 정해지는 슬롯 하나를 덮어씀
+            Slot* victim = slot_at(bucket, (key >> 32) % slots);
+            uint64_t current = __atomic_load_n(&victim->key, __ATOMIC_ACQUIRE);
+            if ((current & 1) != 0 && !stale_claim(current, claim)) return; // 다른 프로세스가 기록 중
+            if (!__atomic_compare_exchange_n(&victim->key, &current, claim, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+                return;
+            }
+            target = victim;
+        }
+
+        target->check = check;
+        std::memcpy(vector_of(target), vec, dimension * sizeof(float));
+        target->checksum = checksum(check, vec);
+        __atomic_store_n(&target->key, key, __ATOMIC_RELEASE);
+    }
+
+    size_t capacity() const {
+        return bucket_count * slots;
+    }
+
+    uint64_t hits() const {
+        return hit_count.load();
+    }
+
+    uint64_t misses() const {
+        return miss_count.load();
+    }
+
+    // 프로세스나 빌드가 달라도 같은 값을 내야 하므로 std::hash 대신 사용 (FNV-1a + splitmix64 마무리)
+    static uint64_t hash64(const void* data, size_t length, uint64_t seed) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        uint64_t h = 1469598103934665603ULL ^ seed;
+        for (size_t i = 0; i < length; i++) {
+            h ^= bytes[i];
+            h *= 1099511628211ULL;
+        }
+        h ^= h >> 30;
+        h *= 0xbf58476d1ce4e5b9ULL;
+        h ^= h >> 27;
+        h *= 0x94d049bb133111ebULL;
+        return h ^ (h >> 31);
+    }
+
+    // 모델/토크나이저 파일 식별값 (경로, 크기, 수정 시각)
+    static uint64_t file_tag(const std::string& path) {
+        struct stat st;
+        uint64_t tag = hash64(path.data(), path.size(), 0);
+        if (stat(path.c_str(), &st) == 0) {
+            uint64_t fields[2] = {static_cast<uint64_t>(st.st_size), static_cast<uint64_t>(st.st_mtime)};
+            tag = hash64(fields, sizeof(fields), tag);
+        }
+        return tag;
+    }
+
+private:
+    struct Header {
+        char magic[8];
+        uint32_t dimension;
+        uint32_t slots_per_bucket;
+        uint64_t bucket_count;
+        char reserved[40];
+    };
+
+    struct Slot {
+        uint64_t key;
+        uint64_t check;
+        uint32_t checksum;
+        uint32_t reserved;
+        // 뒤에 float 벡터 dimension개가 이어짐
+    };
+
+    static const uint64_t claim_timeout_seconds = 60;
+
+    size_t dimension;
+    size_t bucket_count = 0;
+    size_t slots = 0;
+    size_t slot_size = 0;
+    size_t mapping_size = 0;
+    void* mapped = nullptr;
+    char* base = nullptr;
+    std::atomic<uint64_t> hit_count{0};
+    std::atomic<uint64_t> miss_count{0};
+
+    static size_t slot_bytes(size_t dim) {
+        return (sizeof(Slot) + dim * sizeof(float) + 7) & ~static_cast<size_t>(7);
+    }
+
+    static float* vector_of(Slot* slot) {
+        return reinterpret_cast<float*>(slot + 1);
+    }
+
+    Slot* slot_at(Slot* bucket, size_t index) const {
+        return reinterpret_cast<Slot*>(reinterpret_cast<char*>(bucket) + index * slot_size);
+    }
+
+    // 텍스트의 버킷과 키 계산 (key는 0이 아닌 짝수, check는 두 번째 독립 해시)
+    Slot* locate(uint64_t source, const std::string& text, uint64_t& key, uint64_t& check) const {
+        key = hash64(text.data(), text.size(), source);
+        check = hash64(text.data(), text.size(), source ^ 0x9e3779b97f4a7c15ULL);
+        key = (key | 2) & ~1ULL;
+        return reinterpret_cast<Slot*>(base + (check % bucket_count) * slots * slot_size);
+    }
+
+    // 선점한 프로세스가 기록을 마치지 못하고 죽은 슬롯
+    static bool stale_claim(uint64_t current, uint64_t now_claim) {
+        return (current & 1) != 0 && (now_claim >> 1) > (current >> 1) + claim_timeout_seconds;
+    }
+
+    uint32_t checksum(uint64_t check, const float* vec) const {
+        return static_cast<uint32_t>(hash64(vec, dimension * sizeof(float), check));
+    }
+};
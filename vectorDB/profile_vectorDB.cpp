@@ -0,0 +1,147 @@
+// VectorDB 클래스에 추가할 필드와 메서드
+// 검색 프로파일/explain 모드: -DVECTORDB_PROFILE로 빌드할 때만 포함되며, 그렇지 않으면 아무 코드도 생성되지 않습니다.
+#ifdef VECTORDB_PROFILE
+public:
+    // 쿼리 한 건의 프로파일
+    struct QueryProfile {
+        std::vector<size_t> visited_per_layer;   // 레이어별 방문 노드 수 (인덱스 0이 바닥 레이어)
+        size_t distance_computations = 0;
+        size_t effective_ef = 0;                 // 바닥 레이어 탐색에 사용된 ef (max(ef, k))
+        size_t hops = 0;                         // 지표/이진 그래프(hnswlib searchKnn)의 이동 횟수
+        double embed_us = 0;                     // 쿼리 임베딩 시간
+        double traverse_us = 0;                  // 그래프 탐색 시간
+        double materialize_us = 0;               // 결과 텍스트/메타데이터 조립 시간
+        bool query_cache_enabled = false;
+        bool query_cache_hit = false;            // 같은 쿼리가 검색 결과 캐시에 있었는지
+        bool generation_pending = false;         // 저장 중이라 동결/병합 세대가 함께 있는지
+        std::vector<std::pair<std::string, float>> results;
+    };
+
+    // 로그 스케일(2의 거듭제곱) 버킷 히스토그램
+    struct ProfileHistogram {
+        static constexpr int bucket_count = 40;
+        std::atomic<uint64_t> buckets[bucket_count] = {};
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> sum{0};
+
+        void record(uint64_t value) {
+            int bucket = 0;
+            while (bucket < bucket_count - 1 && (1ULL << bucket) <= value) {
+                bucket++;
+            }
+            buckets[bucket]++;
+            count++;
+            sum += value;
+        }
+
+        // 백분위 근사값 (버킷 상한)
+        uint64_t percentile(double p) const {
+            uint64_t total = count.load();
+            if (total == 0) return 0;
+            uint64_t target = static_cast<uint64_t>(std::ceil(total * p));
+            uint64_t seen = 0;
+            for (int b = 0; b < bucket_count; b++) {
+                seen += buckets[b].load();
+                if (seen >= target) return 1ULL << b;
+            }
+            return 1ULL << (bucket_count - 1);
+        }
+
+        void print(const std::string& name, const std::string& unit) const {
+            uint64_t total = count.load();
+            std::cout << "- " << name << ": 건수 " << total
+                      << ", 평균 " << (total ? static_cast<double>(sum.load()) / total : 0.0) << unit
+                      << ", p50 <= " << percentile(0.50) << unit
+                      << ", p90 <= " << percentile(0.90) << unit
+                      << ", p99 <= " << percentile(0.99) << unit << std::endl;
+        }
+    };
+
+private:
+    ProfileHistogram profile_total_us;
+    ProfileHistogram profile_embed_us;
+    ProfileHistogram profile_traverse_us;
+    ProfileHistogram profile_materialize_us;
+    ProfileHistogram profile_visited_nodes;
+    ProfileHistogram profile_distance_computations;
+
+    static double elapsed_us(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    }
+
+public:
+    // explain 검색: 결과와 함께 탐색 통계를 반환하고 누적 히스토그램에 기록
+    // 일반 검색과 같은 search_ids 경로(세대 병합, prefetch 탐색, 지표/이진 그래프)를 그대로 실행하며 계측만 추가합니다.
+    QueryProfile explain_search(const std::string& query, int k = 5, SimilarityType sim_type = COSINE) {
+        QueryProfile profile;
+        auto total_start = std::chrono::steady_clock::now();
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<float> query_embedding = embed_text(query);
+        profile.embed_us = elapsed_us(start);
+
+        // 캐시 상태 (LRU 순서와 적중 통계를 바꾸지 않고 확인만 함)
+        profile.query_cache_enabled = static_cast<bool>(query_cache);
+        if (query_cache) {
+            profile.query_cache_hit = query_cache->contains(query_embedding, k, sim_type, "", index_version.load());
+        }
+        {
+            std::shared_lock<std::shared_mutex> lock(generation_mutex);
+            profile.generation_pending = (frozen_index != nullptr || draining_index != nullptr);
+        }
+
+        start = std::chrono::steady_clock::now();
+        TraversalStats traversal;
+        std::vector<std::pair<float, size_t>> ranked = search_ids(query_embedding, k, sim_type, &traversal);
+        profile.traverse_us = elapsed_us(start);
+        profile.visited_per_layer = std::move(traversal.visited_per_layer);
+        profile.distance_computations = traversal.distance_computations;
+        profile.effective_ef = traversal.effective_ef;
+        profile.hops = traversal.hops;
+
+        start = std::chrono::steady_clock::now();
+        profile.results = materialize_results(ranked);
+        profile.materialize_us = elapsed_us(start);
+
+        size_t visited = profile.hops;
+        for (size_t v : profile.visited_per_layer) visited += v;
+
+        profile_total_us.record(static_cast<uint64_t>(elapsed_us(total_start)));
+        profile_embed_us.record(static_cast<uint64_t>(profile.embed_us));
+        profile_traverse_us.record(static_cast<uint64_t>(profile.traverse_us));
+        profile_materialize_us.record(static_cast<uint64_t>(profile.materialize_us));
+        profile_visited_nodes.record(visited);
+        profile_distance_computations.record(profile.distance_computations);
+
+        return profile;
+    }
+
+    // 쿼리 한 건의 프로파일 출력
+    static void print_profile(const QueryProfile& profile) {
+        std::cout << "검색 프로파일:" << std::endl;
+        for (size_t level = profile.visited_per_layer.size(); level-- > 0;) {
+            std::cout << "- 레이어 " << level << " 방문 노드: " << profile.visited_per_layer[level] << std::endl;
+        }
+        if (profile.hops > 0) {
+            std::cout << "- 그래프 이동 횟수: " << profile.hops << std::endl;
+        }
+        std::cout << "- 거리 계산 횟수: " << profile.distance_computations << std::endl;
+        std::cout << "- 유효 ef: " << profile.effective_ef << std::endl;
+        std::cout << "- 시간(us): 임베딩 " << profile.embed_us
+                  << ", 탐색 " << profile.traverse_us
+                  << ", 결과 조립 " << profile.materialize_us << std::endl;
+        std::cout << "- 검색 결과 캐시: " << (profile.query_cache_enabled ? (profile.query_cache_hit ? "적중" : "미적중") : "비활성")
+                  << (profile.generation_pending ? ", 저장 중(다중 세대)" : "") << std::endl;
+    }
+
+    // 누적 히스토그램 출력 (샤드별 M/ef 튜닝과 지연 이상치 분석용)
+    void report_profile() {
+        std::cout << "검색 프로파일 누적 통계:" << std::endl;
+        profile_total_us.print("전체 시간", "us");
+        profile_embed_us.print("임베딩 시간", "us");
+        profile_traverse_us.print("탐색 시간", "us");
+        profile_materialize_us.print("결과 조립 시간", "us");
+        profile_visited_nodes.print("방문 노드", "개");
+        profile_distance_computations.print("거리 계산", "회");
+    }
+#endif // VECTORDB_PROFILE
@@ -0,0 +1,215 @@
+#include <vector>
+#include <string>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <random>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <atomic>
+#include <stdexcept>
+
+// 검색 결과 캐시
+// 정규화된 쿼리 임베딩을 랜덤 초평면 LSH 서명으로 변환해 (서명, k, 유사도 방식, 필터)를 키로 사용합니다.
+// 같은 키에 저장된 쿼리들과 코사인 유사도를 비교해 임계값 이상이면 근사 일치로 보고 결과를 재사용합니다.
+// 인덱스 버전이 바뀌면(삽입/삭제) 저장된 결과는 모두 무효화됩니다.
+class QueryResultCache {
+public:
+    using Results = std::vector<std::pair<std::string, float>>;
+
+    QueryResultCache(int dim, int num_bits = 16, float similarity_threshold = 0.98f, size_t capacity = 1024)
+        : dimension(dim), signature_bits(num_bits), threshold(similarity_threshold),
+          max_entries(capacity), cached_version(0), hit_count(0), miss_count(0) {
+        if (signature_bits <= 0 || signature_bits > 64) {
+            throw std::runtime_error("LSH 서명 비트 수는 1~64 사이여야 합니다.");
+        }
+
+        // 고정 시드로 초평면 생성 (프로세스마다 같은 서명이 나오도록)
+        std::mt19937 rng(42);
+        std::normal_distribution<float> dist(0.0f, 1.0f);
+        hyperplanes.resize(static_cast<size_t>(signature_bits) * dimension);
+        for (auto& v : hyperplanes) {
+            v = dist(rng);
+        }
+    }
+
+    // 캐시 조회 (query는 정규화된 임베딩이어야 함)
+    bool lookup(const std::vector<float>& query, int k, int sim_type, const std::string& filter,
+                uint64_t version, Results& out) {
+        int weakest_bit = 0;
+        uint64_t signature = compute_signature(query, weakest_bit);
+
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        sync_version(version);
+
+        // 경계에 가까운 쿼리를 위해 가장 불확실한 비트를 뒤집은 서명도 함께 확인 (multi-probe)
+        const uint64_t probes[2] = { signature, signature ^ (1ULL << weakest_bit) };
+        for (uint64_t probe : probes) {
+            uint64_t key = make_key(probe, k, sim_type, filter);
+            auto range = buckets.equal_range(key);
+            for (auto it = range.first; it != range.second; ++it) {
+                const Entry& entry = *it->second;
+                if (entry.k != k || entry.sim_type != sim_type || entry.filter != filter) {
+                    continue;
+                }
+                if (dot(entry.query, query) >= threshold) {
+                    // LRU 갱신
+                    lru.splice(lru.begin(), lru, it->second);
+                    out = entry.results;
+                    hit_count++;
+                    return true;
+                }
+            }
+        }
+
+        miss_count++;
+        return false;
+    }
+
+    // 조회와 같은 기준으로 일치 항목이 있는지만 확인 (LRU 순서, 적중 통계, 저장된 결과를 바꾸지 않음)
+    bool contains(const std::vector<float>& query, int k, int sim_type, const std::string& filter,
+                  uint64_t version) {
+        int weakest_bit = 0;
+        uint64_t signature = compute_signature(query, weakest_bit);
+
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        if (version != cached_version) {
+            return false; // 버전이 바뀌었으면 다음 조회 때 모두 무효화됨
+        }
+
+        const uint64_t probes[2] = { signature, signature ^ (1ULL << weakest_bit) };
+        for (uint64_t probe : probes) {
+            uint64_t key = make_key(probe, k, sim_type, filter);
+            auto range = buckets.equal_range(key);
+            for (auto it = range.first; it != range.second; ++it) {
+                const Entry& entry = *it->second;
+                if (entry.k == k && entry.sim_type == sim_type && entry.filter == filter &&
+                    dot(entry.query, query) >= threshold) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // 검색 결과 저장 (version은 검색을 시작하기 전에 읽은 인덱스 버전)
+    void insert(const std::vector<float>& query, int k, int sim_type, const std::string& filter,
+                uint64_t version, const Results& results) {
+        int weakest_bit = 0;
+        uint64_t signature = compute_signature(query, weakest_bit);
+        uint64_t key = make_key(signature, k, sim_type, filter);
+
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        if (version < cached_version) {
+            return; // 검색 도중 인덱스가 바뀐 결과는 저장하지 않음
+        }
+        sync_version(version);
+
+        if (max_entries == 0) {
+            return;
+        }
+        while (lru.size() >= max_entries) {
+            evict_oldest();
+        }
+
+        lru.push_front(Entry{key, query, k, sim_type, filter, results});
+        buckets.emplace(key, lru.begin());
+    }
+
+    // 전체 비우기 (인덱스를 통째로 교체한 경우 버전 기준도 초기화)
+    void clear() {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        lru.clear();
+        buckets.clear();
+        cached_version = 0;
+    }
+
+    size_t hits() const { return hit_count; }
+    size_t misses() const { return miss_count; }
+
+    size_t size() {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        return lru.size();
+    }
+
+private:
+    struct Entry {
+        uint64_t key;
+        std::vector<float> query;
+        int k;
+        int sim_type;
+        std::string filter;
+        Results results;
+    };
+
+    int dimension;
+    int signature_bits;
+    float threshold;
+    size_t max_entries;
+    uint64_t cached_version;
+    std::atomic<size_t> hit_count;
+    std::atomic<size_t> miss_count;
+
+    std::vector<float> hyperplanes; // signature_bits x dimension
+    std::list<Entry> lru;           // 앞쪽이 최근 사용
+    std::unordered_multimap<uint64_t, std::list<Entry>::iterator> buckets;
+    std::mutex cache_mutex;
+
+    static float dot(const std::vector<float>& a, const std::vector<float>& b) {
+        float sum = 0.0f;
+        for (size_t i = 0; i < a.size() && i < b.size(); i++) {
+            sum += a[i] * b[i];
+        }
+        return sum;
+    }
+
+    // 초평면 투영 부호로 서명 계산, 투영 값이 0에 가장 가까운 비트 위치도 함께 반환
+    uint64_t compute_signature(const std::vector<float>& query, int& weakest_bit) const {
+        uint64_t signature = 0;
+        float weakest_margin = INFINITY;
+        for (int b = 0; b < signature_bits; b++) {
+            const float* plane = &hyperplanes[static_cast<size_t>(b) * dimension];
+            float projection = 0.0f;
+            for (int j = 0; j < dimension && j < static_cast<int>(query.size()); j++) {
+                projection += plane[j] * query[j];
+            }
+            if (projection >= 0.0f) {
+                signature |= (1ULL << b);
+            }
+            if (std::fabs(projection) < weakest_margin) {
+                weakest_margin = std::fabs(projection);
+                weakest_bit = b;
+            }
+        }
+        return signature;
+    }
+
+    static uint64_t make_key(uint64_t signature, int k, int sim_type, const std::string& filter) {
+        uint64_t h = signature;
+        h ^= std::hash<std::string>{}(filter) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+        h ^= (static_cast<uint64_t>(k) << 8 | static_cast<uint64_t>(sim_type)) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+        return h;
+    }
+
+    // 인덱스 버전이 앞서 나가면 저장된 결과를 모두 버림 (cache_mutex 보유 상태에서 호출)
+    void sync_version(uint64_t version) {
+        if (version > cached_version) {
+            lru.clear();
+            buckets.clear();
+            cached_version = version;
+        }
+    }
+
+    void evict_oldest() {
+        auto last = std::prev(lru.end());
+        auto range = buckets.equal_range(last->key);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == last) {
+                buckets.erase(it);
+                break;
+            }
+        }
+        lru.erase(last);
+    }
+};
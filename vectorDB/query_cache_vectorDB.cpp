@@ -0,0 +1,81 @@
+// VectorDB 클래스에 추가할 메서드 (메타데이터 필터 검색과 캐시 보고)
+// 캐시 자체와 필터 없는 검색의 캐시 조회는 vectorDB.cpp의 search_by_embedding에 있습니다.
+private:
+    // 메타데이터 필터 검색: 필터에 맞는 결과가 k개 모일 때까지 후보 수를 늘려가며 검색
+    std::vector<std::pair<std::string, float>> search_filtered(const std::vector<float>& query_embedding,
+                                                             int k, SimilarityType sim_type,
+                                                             const std::string& filter) {
+        std::vector<std::pair<float, size_t>> matched;
+        int fetch = k * 4;
+
+        while (true) {
+            std::vector<std::pair<float, size_t>> ranked = search_ids(query_embedding, fetch, sim_type);
+
+            matched.clear();
+            for (const auto& item : ranked) {
+                if (metadata_at(item.second) == filter) {
+                    matched.push_back(item);
+                    if (matched.size() >= k) break;
+                }
+            }
+
+            // 충분히 모였거나 더 가져올 후보가 없으면 종료
+            if (matched.size() >= k || ranked.size() < fetch || fetch >= stored_texts.size()) {
+                break;
+            }
+            fetch *= 2;
+        }
+
+        return materialize_results(matched);
+    }
+
+public:
+    // 캐시를 거치는 검색 (filter가 비어있지 않으면 메타데이터가 일치하는 항목만 반환)
+    std::vector<std::pair<std::string, float>> search_cached(const std::string& query, int k = 5,
+                                                             SimilarityType sim_type = COSINE,
+                                                             const std::string& filter = "") {
+        std::vector<float> query_embedding = embed_text(query);
+        return search_cached_by_embedding(query_embedding, k, sim_type, filter);
+    }
+
+    std::vector<std::pair<std::string, float>> search_cached_by_embedding(const std::vector<float>& query_embedding,
+                                                                          int k = 5,
+                                                                          SimilarityType sim_type = COSINE,
+                                                                          const std::string& filter = "") {
+        if (filter.empty()) {
+            return search_by_embedding(query_embedding, k, sim_type);
+        }
+
+        // 검색 전에 버전을 읽어야 검색 도중 추가된 항목이 있을 때 오래된 결과가 캐시에 남지 않음
+        uint64_t version = index_version.load();
+
+        QueryResultCache::Results results;
+        if (query_cache) {
+            if (query_cache->lookup(query_embedding, k, sim_type, filter, version, results)) {
+                metrics.add(COUNTER_QUERY_CACHE_HITS);
+                return results;
+            }
+            metrics.add(COUNTER_QUERY_CACHE_MISSES);
+        }
+
+        results = search_filtered(query_embedding, k, sim_type, filter);
+
+        if (query_cache) {
+            query_cache->insert(query_embedding, k, sim_type, filter, version, results);
+        }
+        return results;
+    }
+
+    // 캐시 적중률 보고
+    void report_query_cache() {
+        if (!query_cache) {
+            std::cout << "검색 결과 캐시가 비활성화 상태입니다." << std::endl;
+            return;
+        }
+        size_t hits = query_cache->hits();
+        size_t misses = query_cache->misses();
+        size_t total = hits + misses;
+        std::cout << "검색 결과 캐시: 항목 " << query_cache->size()
+                  << ", 적중 " << hits << "/" << total
+                  << " (" << (total ? 100.0 * hits / total : 0.0) << "%)" << std::endl;
+    }
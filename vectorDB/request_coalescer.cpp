@@ -0,0 +1,152 @@
+#include <vector>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <algorithm>
+
+// 요청 병합기 (threadpool.cpp의 ThreadPool 필요)
+// 짧은 시간(window) 안에 들어온 단건 요청들을 모아 한 번의 배치 처리로 스레드 풀에서 실행합니다.
+// 배치가 max_batch에 도달하면 window를 기다리지 않고 바로 실행합니다.
+template<typename Request, typename Result>
+class RequestCoalescer {
+public:
+    using BatchHandler = std::function<std::vector<Result>(const std::vector<Request>&)>;
+
+    RequestCoalescer(ThreadPool& thread_pool, BatchHandler batch_handler,
+                     std::chrono::microseconds batch_window = std::chrono::microseconds(2000),
+                     size_t max_batch_size = 32)
+        : pool(thread_pool), handler(std::move(batch_handler)),
+          window(batch_window), max_batch(max_batch_size), stop(false), in_flight(0) {
+        dispatcher = std::thread([this] { dispatch_loop(); });
+    }
+
+    ~RequestCoalescer() {
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            stop = true;
+        }
+        condition.notify_all();
+        dispatcher.join();
+
+        // 풀에서 실행 중인 배치가 끝날 때까지 대기 (배치 처리기가 소유 객체를 참조하므로)
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        condition.wait(lock, [this] { return in_flight == 0; });
+    }
+
+    std::future<Result> submit(Request request) {
+        Pending item;
+        item.request = std::move(request);
+        std::future<Result> result = item.promise.get_future();
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            if (stop) {
+                throw std::runtime_error("요청 병합기가 이미 종료되었습니다");
+            }
+            if (pending.empty()) {
+                batch_deadline = std::chrono::steady_clock::now() + window;
+            }
+            pending.push_back(std::move(item));
+        }
+        condition.notify_all();
+        return result;
+    }
+
+    // 아직 배치로 보내지 않은 요청 수
+    size_t queue_depth() {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        return pending.size();
+    }
+
+private:
+    struct Pending {
+        Request request;
+        std::promise<Result> promise;
+    };
+
+    ThreadPool& pool;
+    BatchHandler handler;
+    std::chrono::microseconds window;
+    size_t max_batch;
+
+    std::vector<Pending> pending;
+    std::chrono::steady_clock::time_point batch_deadline;
+    std::mutex queue_mutex;
+    std::condition_variable condition;
+    std::thread dispatcher;
+    bool stop;
+    size_t in_flight;
+
+    void dispatch_loop() {
+        while (true) {
+            std::vector<Pending> batch;
+            {
+                std::unique_lock<std::mutex> lock(queue_mutex);
+                condition.wait(lock, [this] { return stop || !pending.empty(); });
+                if (pending.empty()) {
+                    return; // stop이고 남은 요청 없음
+                }
+
+                // 첫 요청 이후 window가 지나거나 배치가 가득 찰 때까지 대기
+                condition.wait_until(lock, batch_deadline, [this] {
+                    return stop || pending.size() >= max_batch;
+                });
+
+                size_t count = std::min(pending.size(), max_batch);
+                batch.reserve(count);
+                for (size_t i = 0; i < count; i++) {
+                    batch.push_back(std::move(pending[i]));
+                }
+                pending.erase(pending.begin(), pending.begin() + count);
+                if (!pending.empty()) {
+                    batch_deadline = std::chrono::steady_clock::now() + window;
+                }
+                in_flight++;
+            }
+
+            auto shared_batch = std::make_shared<std::vector<Pending>>(std::move(batch));
+            try {
+                pool.enqueue([this, shared_batch]() { run_batch(*shared_batch); });
+            } catch (...) {
+                // 풀이 이미 종료됨: 이 배치의 요청들을 실패로 알리고 계속 진행
+                for (auto& item : *shared_batch) {
+                    item.promise.set_exception(std::current_exception());
+                }
+                std::unique_lock<std::mutex> lock(queue_mutex);
+                in_flight--;
+                condition.notify_all();
+            }
+        }
+    }
+
+    void run_batch(std::vector<Pending>& batch) {
+        std::vector<Request> requests;
+        requests.reserve(batch.size());
+        for (auto& item : batch) {
+            requests.push_back(item.request);
+        }
+
+        try {
+            std::vector<Result> results = handler(requests);
+            if (results.size() != batch.size()) {
+                throw std::runtime_error("배치 처리 결과 수가 요청 수와 다릅니다");
+            }
+            for (size_t i = 0; i < batch.size(); i++) {
+                batch[i].promise.set_value(std::move(results[i]));
+            }
+        } catch (...) {
+            for (auto& item : batch) {
+                item.promise.set_exception(std::current_exception());
+            }
+        }
+
+        // 잠금을 쥔 채로 알려야 소멸자가 condition을 먼저 파괴하지 않음
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        in_flight--;
+        condition.notify_all();
+    }
+};
@@ -56,6 +56,12 @@ public:
         return result;
     }
     
+    // 아직 시작되지 않은 작업 수
+    size_t queue_depth() {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        return tasks.size();
+    }
+    
     ~ThreadPool() {
         {
             std::unique_lock<std::mutex> lock(queue_mutex);
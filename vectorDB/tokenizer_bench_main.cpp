@@ -0,0 +1,104 @@
+#include <chrono>
+
+// 토큰화 처리량 측정
+// 사용법: tokenizer_bench <tokenizer.model> [텍스트 파일] [반복 횟수]
+// 1) 기존 방식: 조각 문자열로 인코딩 후 PieceToId 조회
+// 2) ID 직접 인코딩 + 버퍼 재사용
+// 3) VectorDB 경로 (ID 직접 인코딩 + 짧은 문자열 캐시)
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "사용법: " << argv[0] << " <tokenizer.model> [텍스트 파일] [반복 횟수]" << std::endl;
+        return 1;
+    }
+
+    sentencepiece::SentencePieceProcessor processor;
+    if (!processor.Load(argv[1]).ok()) {
+        std::cerr << "토크나이저를 로드할 수 없습니다: " << argv[1] << std::endl;
+        return 1;
+    }
+
+    VectorDB db(128, 10);
+    db.load_tokenizer(argv[1]);
+
+    // 샘플 텍스트 준비 (파일이 없으면 기본 문장 사용)
+    std::vector<std::string> texts;
+    if (argc >= 3) {
+        std::ifstream input_file(argv[2]);
+        std::string line;
+        while (std::getline(input_file, line)) {
+            if (!line.empty()) texts.push_back(line);
+        }
+    }
+    if (texts.empty()) {
+        texts = {
+            "라즈베리파이는 저비용 소형 컴퓨터입니다.",
+            "벡터 데이터베이스는 임베딩을 저장하고 검색하는데 사용됩니다.",
+            "C++은 성능이 중요한 응용 프로그램에 적합합니다.",
+            "임베딩은 텍스트나 이미지를 벡터로 변환하는 과정입니다.",
+            "코사인 유사도는 두 벡터 간의 각도를 측정하는 방법입니다."
+        };
+    }
+    int iterations = argc >= 4 ? std::stoi(argv[3]) : 10000;
+
+    size_t total_bytes = 0;
+    for (const auto& text : texts) {
+        total_bytes += text.size();
+    }
+
+    auto report = [&](const std::string& name, std::chrono::steady_clock::duration elapsed, size_t tokens) {
+        double seconds = std::chrono::duration<double>(elapsed).count();
+        double calls = static_cast<double>(texts.size()) * iterations;
+        std::cout << name << ": " << (calls / seconds) << " 문장/초, "
+                  << (total_bytes * iterations / seconds / 1024.0 / 1024.0) << " MB/초, "
+                  << "토큰 " << tokens << "개" << std::endl;
+    };
+
+    // 1) 조각 문자열 + PieceToId
+    {
+        size_t tokens = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int it = 0; it < iterations; it++) {
+            for (const auto& text : texts) {
+                std::vector<std::string> pieces;
+                std::vector<int> ids;
+                processor.Encode(text, &pieces);
+                for (const auto& piece : pieces) {
+                    ids.push_back(processor.PieceToId(piece));
+                }
+                tokens += ids.size();
+            }
+        }
+        report("조각 문자열 + PieceToId", std::chrono::steady_clock::now() - start, tokens);
+    }
+
+    // 2) ID 직접 인코딩 (버퍼 재사용)
+    {
+        size_t tokens = 0;
+        std::vector<int> ids;
+        auto start = std::chrono::steady_clock::now();
+        for (int it = 0; it < iterations; it++) {
+            for (const auto& text : texts) {
+                ids.clear();
+                processor.Encode(text, &ids);
+                tokens += ids.size();
+            }
+        }
+        report("ID 직접 인코딩", std::chrono::steady_clock::now() - start, tokens);
+    }
+
+    // 3) VectorDB 경로 (ID 직접 인코딩 + 토큰 ID 캐시)
+    {
+        size_t tokens = 0;
+        std::vector<int> ids;
+        auto start = std::chrono::steady_clock::now();
+        for (int it = 0; it < iterations; it++) {
+            for (const auto& text : texts) {
+                db.tokenize(text, ids);
+                tokens += ids.size();
+            }
+        }
+        report("VectorDB (캐시 포함)", std::chrono::steady_clock::now() - start, tokens);
+    }
+
+    return 0;
+}
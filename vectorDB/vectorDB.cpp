@@ -3,28 +3,180 @@
 #include <string>
 #include <fstream>
 #include <cmath>
+#include <queue>
+#include <atomic>
+#include <algorithm>
+#include <random>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <future>
+#include <unordered_set>
+#include <unordered_map>
+#include <thread>
+#include <functional>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <hnswlib/hnswlib.h>
 #include <nlohmann/json.hpp>
 #include <sentencepiece_processor.h>
+#include "minilm_embedder.cpp"
+#include "metric_spaces.cpp"
+#include "binary_index.cpp"
+#include "graph_layout.cpp"
+#include "persistent_embedding_cache.cpp"
+#include "metrics.cpp"
+#include "query_cache.cpp"
 
 using json = nlohmann::json;
 
+// 자주 나오는 짧은 문자열의 토큰 ID 캐시
+// 문자열 해시로 샤드를 나누고 샤드마다 잠금을 따로 두어 OpenMP 스레드 간 경합을 줄입니다.
+class TokenIdCache {
+public:
+    static constexpr size_t max_key_length = 64; // 이보다 긴 문자열은 캐시하지 않음
+    
+    explicit TokenIdCache(size_t capacity = 8192)
+        : capacity_per_shard(std::max<size_t>(1, capacity / shard_count)) {}
+    
+    bool get(const std::string& text, std::vector<int>& ids) {
+        Shard& shard = shard_for(text);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.entries.find(text);
+        if (it == shard.entries.end()) {
+            return false;
+        }
+        ids.assign(it->second.begin(), it->second.end());
+        return true;
+    }
+    
+    void put(const std::string& text, const std::vector<int>& ids) {
+        Shard& shard = shard_for(text);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (shard.entries.size() >= capacity_per_shard) {
+            // 가득 차면 샤드를 통째로 비움 (자주 나오는 문자열은 곧 다시 채워짐)
+            shard.entries.clear();
+        }
+        shard.entries.emplace(text, ids);
+    }
+    
+    // 토크나이저가 바뀌면 이전 모델의 ID는 쓸 수 없으므로 모두 비움
+    void clear() {
+        for (auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.entries.clear();
+        }
+    }
+    
+private:
+    static constexpr size_t shard_count = 16;
+    
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<std::string, std::vector<int>> entries;
+    };
+    
+    size_t capacity_per_shard;
+    Shard shards[shard_count];
+    
+    Shard& shard_for(const std::string& text) {
+        return shards[std::hash<std::string>{}(text) % shard_count];
+    }
+};
+
 class VectorDB {
 private:
     // HNSW 인덱스 관련 변수
     hnswlib::HierarchicalNSW<float>* index;
+    std::unique_ptr<hnswlib::SpaceInterface<float>> index_space; // 인덱스보다 오래 살아야 함
     int vector_dimension;
     int max_elements;
     
+    // 세대(generation) 관리
+    // save 중에는 현재 인덱스를 동결(frozen_index)해 디스크에 쓰고, 새 삽입은 새 세대(index)로 받습니다.
+    // 저장이 끝나면 새 세대의 항목을 동결했던 인덱스로 옮기는 동안(draining_index) 두 세대를 함께 검색합니다.
+    hnswlib::HierarchicalNSW<float>* frozen_index = nullptr;
+    hnswlib::HierarchicalNSW<float>* draining_index = nullptr;
+    std::shared_mutex generation_mutex; // 세대 포인터 교체 시 배타적, 검색/삽입 시 공유
+    std::mutex append_mutex;            // ID 할당과 텍스트 저장소 추가
+    std::mutex save_mutex;              // 동시에 하나의 저장만 진행
+    std::shared_future<bool> pending_save;
+    bool reorder_on_save = false;       // 저장할 때 동결된 세대의 그래프를 캐시 지역성 순서로 재배치
+    
+    // 지표별 그래프: 주 인덱스가 처리하지 않는 지표(예: MANHATTAN)는 해당 지표의 그래프로 검색
+    // 지표 그래프들은 벡터 대신 vector_store의 포인터만 저장하므로 벡터는 한 벌만 유지됩니다.
+    // 처음 필요할 때(또는 enable_metric_index 호출 시) 만들고 이후 삽입마다 함께 갱신합니다.
+    int primary_metric;                                           // 주 인덱스가 처리하는 지표 (SimilarityType)
+    std::unique_ptr<float[]> vector_store;                        // ID 순서의 벡터 [max_elements, dimension]
+    std::unique_ptr<MetricSpace> metric_space[4];
+    std::unique_ptr<hnswlib::HierarchicalNSW<float>> metric_index[4];
+    
+    // 이진 양자화 검색 (enable_binary_index로 활성화, 코사인/닷 프로덕트 검색에 사용)
+    // 해밍 거리로 후보를 고른 뒤 int8 코드 또는 float 벡터(vector_store)로 다시 채점합니다.
+    std::atomic<int> binary_mode{0};            // BinarySearchMode
+    bool binary_int8 = true;                    // false면 float 벡터로 재채점
+    size_t binary_rescore_factor = 8;           // 재채점할 후보 수 = k * binary_rescore_factor
+    std::unique_ptr<BinaryIndex> binary_index;
+    std::unique_ptr<HammingSpace> binary_space;
+    std::unique_ptr<hnswlib::HierarchicalNSW<float>> binary_graph; // BINARY_GRAPH: 이진 코드 위의 HNSW
+    
     // 임베딩 모델 관련 변수
     sentencepiece::SentencePieceProcessor* tokenizer;
-    std::vector<float> model_weights;
+    TokenIdCache token_cache;
+    std::unique_ptr<MiniLMEmbedder> embedding_model; // 로드되지 않았으면 간단한 임베딩 함수 사용
     int embedding_dim;
     
+    // 디스크 임베딩 캐시 (open_embedding_cache 호출 시 생성, 같은 노드의 프로세스끼리 공유)
+    // 키에는 토크나이저/모델 파일 식별값이 포함되어 모델이 바뀌면 이전 임베딩을 쓰지 않음
+    std::unique_ptr<PersistentEmbeddingCache> persistent_cache;
+    uint64_t tokenizer_tag = 0;
+    uint64_t model_tag = 0;
+    
+    uint64_t embedding_source() const {
+        uint64_t tags[3] = {tokenizer_tag, model_tag, static_cast<uint64_t>(embedding_dim)};
+        return PersistentEmbeddingCache::hash64(tags, sizeof(tags), 0);
+    }
+    
     // 메타데이터 저장
     std::vector<std::string> stored_texts;
     std::vector<std::string> stored_metadata;
 
+    // 인덱스 버전 (삽입/삭제 시 증가, 검색 결과 캐시 무효화에 사용)
+    std::atomic<uint64_t> index_version{0};
+    
+    // 검색 결과 캐시 (enable_query_cache로 활성화, search/search_by_embedding이 먼저 조회)
+    std::unique_ptr<QueryResultCache> query_cache;
+    
+    // 소멸 시 인덱스를 해제하기 전에 실행할 정리 작업
+    // (비동기 API처럼 이 객체를 참조하는 작업을 백그라운드에서 돌리는 기능이 등록)
+    std::vector<std::function<void()>> shutdown_hooks;
+    
+    // 연산별 지연 시간 히스토그램과 카운터 (metrics_snapshot, metrics_prometheus로 조회)
+    enum MetricHistogram { METRIC_SEARCH, METRIC_ADD, METRIC_EMBED, METRIC_EMBED_BATCH, METRIC_SAVE, METRIC_LOAD };
+    enum MetricCounter {
+        COUNTER_EMBEDDING_CACHE_HITS,
+        COUNTER_EMBEDDING_CACHE_MISSES,
+        COUNTER_QUERY_CACHE_HITS,
+        COUNTER_QUERY_CACHE_MISSES
+    };
+    MetricsRegistry metrics{{"search", "add", "embed", "embed_batch", "save", "load"},
+                            {"embedding_cache_hits", "embedding_cache_misses", "query_cache_hits", "query_cache_misses"}};
+    
+    // 빠른 시작 로드: .strings 파일을 메모리 매핑해 두고 [0, lazy_count) 항목은 처음 접근할 때 디코딩
+    // .strings 형식: "VDBSTR01" | uint64 개수 N | uint64 오프셋[2N+1] | 바이트 블록
+    // (항목 i의 텍스트는 [off[2i], off[2i+1]), 메타데이터는 [off[2i+1], off[2i+2]))
+    const char* lazy_mapping = nullptr;
+    size_t lazy_mapping_size = 0;
+    const uint64_t* lazy_offsets = nullptr;
+    const char* lazy_blob = nullptr;
+    size_t lazy_count = 0;
+    std::unique_ptr<std::atomic<uint8_t>[]> lazy_state; // 0: 미디코딩, 1: 디코딩 중, 2: 완료
+    std::thread warmup_thread;
+    std::atomic<bool> warmup_stop{false};
+
     // 유틸리티 함수
     std::vector<float> normalize_vector(const std::vector<float>& vec) {
         float sum = 0.0f;
@@ -40,31 +192,527 @@ private:
         return normalized;
     }
     
-    // 간단한 임베딩 모델 (실제로는 외부 라이브러리 사용 권장)
+    // 텍스트 임베딩 (load_embedding_model로 모델을 로드하면 트랜스포머 인코더 사용)
     std::vector<float> embed_text(const std::string& text) {
-        // 실제 구현에서는 여기에 임베딩 모델을 연결해야 합니다
-        // 이 예제에서는 간단한 임베딩 함수로 대체합니다
+        MetricsRegistry::Timer timer(metrics, METRIC_EMBED);
+        std::vector<float> embedding(embedding_dim);
+        if (persistent_cache) {
+            if (persistent_cache->lookup(embedding_source(), text, embedding.data())) {
+                metrics.add(COUNTER_EMBEDDING_CACHE_HITS);
+                return embedding;
+            }
+            metrics.add(COUNTER_EMBEDDING_CACHE_MISSES);
+        }
         
-        std::vector<std::string> tokens;
-        std::vector<int> ids;
-        tokenizer->Encode(text, &tokens);
+        // 스레드별로 재사용하는 토큰 ID 버퍼 (호출마다 할당하지 않음)
+        thread_local std::vector<int> ids;
+        encode_ids(text, ids);
+        embedding = embed_ids(ids);
         
-        // 토큰 ID로 변환
-        for (const auto& token : tokens) {
-            ids.push_back(tokenizer->PieceToId(token));
+        if (persistent_cache) {
+            persistent_cache->insert(embedding_source(), text, embedding.data());
+        }
+        return embedding;
+    }
+    
+    // 토큰 ID를 임베딩
+    std::vector<float> embed_ids(const std::vector<int>& ids) {
+        if (embedding_model) {
+            return embedding_model->embed(ids);
         }
         
-        // 간단한 임베딩 생성 (실제 구현에서는 모델 가중치 사용)
+        // 모델이 없을 때 사용하는 간단한 임베딩
         std::vector<float> embedding(embedding_dim, 0.0f);
         for (size_t i = 0; i < ids.size() && i < 512; i++) {
             for (int j = 0; j < embedding_dim; j++) {
-                // 실제로는 여기서 모델의 가중치를 사용해야 합니다
                 embedding[j] += std::sin(ids[i] * (j + 1.0f) / embedding_dim);
             }
         }
         
         return normalize_vector(embedding);
     }
+    
+    // 여러 텍스트를 한 번에 임베딩
+    // 모델이 있으면 길이가 다른 문장들을 묶어 배치 단위로 인코딩 (가중치를 배치당 한 번만 읽음)
+    std::vector<std::vector<float>> embed_texts(const std::vector<std::string>& texts) {
+        MetricsRegistry::Timer timer(metrics, METRIC_EMBED_BATCH);
+        std::vector<std::vector<float>> embeddings(texts.size());
+        if (!embedding_model) {
+            #pragma omp parallel for
+            for (size_t i = 0; i < texts.size(); i++) {
+                embeddings[i] = embed_text(texts[i]);
+            }
+            return embeddings;
+        }
+        
+        // 디스크 캐시에 있는 텍스트는 제외하고 나머지만 모델로 계산
+        std::vector<size_t> pending;
+        uint64_t source = embedding_source();
+        for (size_t i = 0; i < texts.size(); i++) {
+            embeddings[i].resize(embedding_dim);
+            if (!persistent_cache || !persistent_cache->lookup(source, texts[i], embeddings[i].data())) {
+                pending.push_back(i);
+            }
+        }
+        if (persistent_cache) {
+            metrics.add(COUNTER_EMBEDDING_CACHE_HITS, texts.size() - pending.size());
+            metrics.add(COUNTER_EMBEDDING_CACHE_MISSES, pending.size());
+        }
+        
+        std::vector<std::vector<int>> ids(pending.size());
+        #pragma omp parallel for
+        for (size_t i = 0; i < pending.size(); i++) {
+            encode_ids(texts[pending[i]], ids[i]);
+        }
+        
+        const size_t batch_size = 32;
+        for (size_t start = 0; start < pending.size(); start += batch_size) {
+            size_t end = std::min(start + batch_size, pending.size());
+            std::vector<std::vector<int>> batch(ids.begin() + start, ids.begin() + end);
+            std::vector<std::vector<float>> batch_embeddings = embedding_model->embed_batch(batch);
+            for (size_t i = start; i < end; i++) {
+                embeddings[pending[i]] = std::move(batch_embeddings[i - start]);
+                if (persistent_cache) {
+                    persistent_cache->insert(source, texts[pending[i]], embeddings[pending[i]].data());
+                }
+            }
+        }
+        return embeddings;
+    }
+    
+    // 텍스트를 토큰 ID로 변환 (조각 문자열을 거치지 않고 바로 ID로 인코딩)
+    void encode_ids(const std::string& text, std::vector<int>& ids) {
+        bool cacheable = text.size() <= TokenIdCache::max_key_length;
+        if (cacheable && token_cache.get(text, ids)) {
+            return;
+        }
+        
+        // SentencePieceProcessor::Encode는 로드된 모델을 읽기만 하는 const 메서드이므로
+        // 하나의 프로세서를 OpenMP 스레드들이 공유해도 안전함 (스레드별 프로세서 불필요)
+        ids.clear();
+        auto status = tokenizer->Encode(text, &ids);
+        if (!status.ok()) {
+            // 토크나이저가 로드되지 않은 경우 등: 빈 결과를 캐시하지 않음
+            ids.clear();
+            return;
+        }
+        
+        if (cacheable) {
+            token_cache.put(text, ids);
+        }
+    }
+    
+    // 임베딩을 인덱스에 추가하고 원본 텍스트와 메타데이터 저장, 할당된 ID 반환
+    size_t append_entry(const std::string& text, const std::string& metadata,
+                        const std::vector<float>& embedding) {
+        MetricsRegistry::Timer timer(metrics, METRIC_ADD);
+        
+        // 세대 교체가 ID 할당과 addPoint 사이에 끼어들지 않도록 공유 잠금을 먼저 잡음
+        // (동결 시점의 인덱스에는 정확히 [0, 저장된 개수) 범위의 ID만 들어있게 됨)
+        std::shared_lock<std::shared_mutex> generation_lock(generation_mutex);
+        
+        size_t id;
+        {
+            std::lock_guard<std::mutex> lock(append_mutex);
+            id = stored_texts.size();
+            if (id >= max_elements) {
+                throw std::runtime_error("최대 저장 용량에 도달했습니다.");
+            }
+            // 용량을 미리 확보해 두었으므로 재할당이 없어 동시 검색/저장 중에도 기존 원소는 그대로 유지됨
+            stored_texts.push_back(text);
+            stored_metadata.push_back(metadata);
+            
+            // float 재채점은 vector_store를 읽으므로 이진 코드를 공개하기 전에 벡터부터 기록
+            if (vector_store) {
+                std::memcpy(vector_at(id), embedding.data(), vector_dimension * sizeof(float));
+            }
+            
+            // 이진 코드는 ID 순서대로 공개되어야 하므로 ID 할당과 함께 기록
+            if (binary_index) {
+                binary_index->add(id, embedding.data());
+                binary_index->publish(id + 1);
+            }
+        }
+        
+        // hnswlib는 동시 addPoint/searchKnn을 지원함
+        index->addPoint(embedding.data(), id);
+        if (vector_store) {
+            const float* stored = vector_at(id);
+            for (auto& graph : metric_index) {
+                if (graph) graph->addPoint(&stored, id);
+            }
+        }
+        if (binary_graph) {
+            binary_graph->addPoint(binary_index->code_at(id), id);
+        }
+        index_version++;
+        return id;
+    }
+    
+    float* vector_at(size_t id) {
+        return vector_store.get() + id * vector_dimension;
+    }
+    
+    // 주 인덱스로 처리하는 지표인지 (코사인 공간은 정규화된 벡터를 쓰므로 닷 프로덕트도 처리)
+    bool served_by_primary(int sim_type) const {
+        if (primary_metric == COSINE) {
+            return sim_type == COSINE || sim_type == DOT_PRODUCT;
+        }
+        return sim_type == primary_metric;
+    }
+    
+    // hnswlib 거리를 유사도 점수로 변환 (클수록 유사)
+    static float distance_to_score(int sim_type, float distance) {
+        switch (sim_type) {
+            case COSINE:      return 1.0f - distance;         // 코사인 유사도 = 1 - 거리
+            case DOT_PRODUCT: return -distance;               // HNSW에서는 거리가 음수로 저장됨
+            case EUCLIDEAN:   return -std::sqrt(distance);    // 제곱 거리 -> 거리, 작을수록 유사
+            default:          return -distance;               // 맨해튼 거리, 작을수록 유사
+        }
+    }
+    
+    // 모든 세대에 저장된 벡터 순회 (generation_mutex를 잡은 상태에서 호출)
+    template<typename Visitor>
+    void for_each_indexed_vector(Visitor visit) {
+        for (auto generation : {index, frozen_index, draining_index}) {
+            if (generation == nullptr) continue;
+            for (hnswlib::tableint i = 0; i < generation->cur_element_count; i++) {
+                visit(generation->getExternalLabel(i),
+                      reinterpret_cast<const float*>(generation->getDataByInternalId(i)));
+            }
+        }
+    }
+    
+    // 공유 벡터 저장소 생성 (generation_mutex를 배타적으로 잡은 상태에서 호출)
+    void ensure_vector_store() {
+        if (vector_store) {
+            return;
+        }
+        vector_store.reset(new float[static_cast<size_t>(max_elements) * vector_dimension]);
+        for_each_indexed_vector([this](size_t id, const float* vec) {
+            std::memcpy(vector_at(id), vec, vector_dimension * sizeof(float));
+        });
+    }
+    
+    // 지표 그래프 생성
+    // 삽입/검색을 잠시 멈추고 기존 항목을 병렬로 추가합니다.
+    void build_metric_index(int sim_type) {
+        std::unique_lock<std::shared_mutex> lock(generation_mutex);
+        if (metric_index[sim_type]) {
+            return;
+        }
+        ensure_vector_store();
+        
+        static const MetricSpace::Metric metrics[4] = {
+            MetricSpace::COSINE, MetricSpace::INNER_PRODUCT, MetricSpace::L2, MetricSpace::L1
+        };
+        metric_space[sim_type].reset(new MetricSpace(vector_dimension, metrics[sim_type], true));
+        hnswlib::HierarchicalNSW<float>* graph =
+            new hnswlib::HierarchicalNSW<float>(metric_space[sim_type].get(), max_elements);
+        
+        size_t count = stored_texts.size();
+        #pragma omp parallel for
+        for (size_t id = 0; id < count; id++) {
+            const float* stored = vector_at(id);
+            graph->addPoint(&stored, id);
+        }
+        metric_index[sim_type].reset(graph);
+    }
+    
+    // 이진 인덱스 생성 (BINARY_GRAPH면 이진 코드 위의 HNSW 그래프도 생성)
+    void build_binary_index() {
+        std::unique_lock<std::shared_mutex> lock(generation_mutex);
+        if (binary_index || binary_mode == BINARY_OFF) {
+            return;
+        }
+        if (!binary_int8) {
+            ensure_vector_store();
+        }
+        
+        std::unique_ptr<BinaryIndex> binary(new BinaryIndex(vector_dimension, max_elements, binary_int8));
+        for_each_indexed_vector([&binary](size_t id, const float* vec) {
+            binary->add(id, vec);
+        });
+        binary->publish(stored_texts.size());
+        
+        if (binary_mode == BINARY_GRAPH) {
+            binary_space.reset(new HammingSpace(binary->code_words()));
+            hnswlib::HierarchicalNSW<float>* graph =
+                new hnswlib::HierarchicalNSW<float>(binary_space.get(), max_elements);
+            size_t count = binary->size();
+            #pragma omp parallel for
+            for (size_t id = 0; id < count; id++) {
+                graph->addPoint(binary->code_at(id), id);
+            }
+            binary_graph.reset(graph);
+        }
+        binary_index = std::move(binary);
+    }
+    
+    // 이진 양자화 검색: 해밍 후보(전수 스캔 또는 이진 그래프)를 재채점해 상위 k개를 ranked에 채움
+    // 잠금을 놓은 사이 이진 인덱스가 꺼져 인덱스가 없으면 false (호출자는 그래프 검색으로 진행)
+    bool search_binary(const std::vector<float>& query_embedding, int k, int sim_type,
+                       std::vector<std::pair<float, size_t>>& ranked, TraversalStats* stats = nullptr) {
+        std::shared_lock<std::shared_mutex> lock(generation_mutex);
+        if (!binary_index) {
+            lock.unlock();
+            build_binary_index();
+            lock.lock();
+            if (!binary_index) {
+                return false;
+            }
+        }
+        
+        size_t candidate_count = static_cast<size_t>(k) * binary_rescore_factor;
+        std::vector<size_t> candidates;
+        if (binary_graph) {
+            std::vector<uint64_t> code(binary_index->code_words());
+            binary_index->encode(query_embedding.data(), code.data());
+            std::vector<float> distances;
+            std::vector<hnswlib::labeltype> labels;
+            count_hnswlib_search(*binary_graph, candidate_count, stats, [&]() {
+                binary_graph->searchKnn(code.data(), candidate_count, &labels, &distances);
+            });
+            candidates.assign(labels.begin(), labels.end());
+        } else {
+            candidates = binary_index->candidates(query_embedding.data(), candidate_count);
+            if (stats) stats->distance_computations += binary_index->size();
+        }
+        
+        ranked.clear();
+        ranked.reserve(candidates.size());
+        for (size_t id : candidates) {
+            float distance = binary_index->has_int8()
+                ? 1.0f - binary_index->int8_dot(query_embedding.data(), id)
+                : MetricSpace::ip_distance(query_embedding.data(), vector_at(id), vector_dimension);
+            ranked.emplace_back(distance_to_score(sim_type, distance), id);
+        }
+        
+        size_t top = std::min(static_cast<size_t>(k), ranked.size());
+        std::partial_sort(ranked.begin(), ranked.begin() + top, ranked.end(),
+                          [](const std::pair<float, size_t>& a, const std::pair<float, size_t>& b) {
+                              return a.first > b.first;
+                          });
+        ranked.resize(top);
+        return true;
+    }
+    
+    // 벡터가 바뀌었을 때 지표 그래프와 이진 인덱스 폐기 (다음 검색 때 다시 생성)
+    void reset_metric_indexes() {
+        for (int i = 0; i < 4; i++) {
+            metric_index[i].reset();
+            metric_space[i].reset();
+        }
+        binary_graph.reset();
+        binary_space.reset();
+        binary_index.reset();
+        vector_store.reset();
+    }
+    
+    // 지연 로드된 항목을 필요할 때 디코딩
+    void materialize(size_t id) {
+        if (id >= lazy_count) {
+            return;
+        }
+        std::atomic<uint8_t>& state = lazy_state[id];
+        if (state.load(std::memory_order_acquire) == 2) {
+            return;
+        }
+        
+        uint8_t expected = 0;
+        if (state.compare_exchange_strong(expected, 1, std::memory_order_acq_rel)) {
+            stored_texts[id].assign(lazy_blob + lazy_offsets[2 * id], lazy_offsets[2 * id + 1] - lazy_offsets[2 * id]);
+            stored_metadata[id].assign(lazy_blob + lazy_offsets[2 * id + 1], lazy_offsets[2 * id + 2] - lazy_offsets[2 * id + 1]);
+            state.store(2, std::memory_order_release);
+        } else {
+            // 다른 스레드가 디코딩 중 (문자열 하나라 금방 끝남)
+            while (state.load(std::memory_order_acquire) != 2) {
+                std::this_thread::yield();
+            }
+        }
+    }
+    
+    const std::string& text_at(size_t id) {
+        materialize(id);
+        return stored_texts[id];
+    }
+    
+    const std::string& metadata_at(size_t id) {
+        materialize(id);
+        return stored_metadata[id];
+    }
+    
+    // 메모리 매핑과 워밍업 스레드 정리
+    void release_lazy_mapping() {
+        if (warmup_thread.joinable()) {
+            warmup_stop = true;
+            warmup_thread.join();
+            warmup_stop = false;
+        }
+        if (lazy_mapping != nullptr) {
+            munmap(const_cast<char*>(lazy_mapping), lazy_mapping_size);
+        }
+        lazy_mapping = nullptr;
+        lazy_mapping_size = 0;
+        lazy_offsets = nullptr;
+        lazy_blob = nullptr;
+        lazy_count = 0;
+        lazy_state.reset();
+    }
+    
+    // .strings 파일 매핑 (텍스트는 디코딩하지 않고 빈 자리만 만들어 둠)
+    bool map_strings_file(const std::string& file_path) {
+        int fd = open(file_path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < 16) {
+            close(fd);
+            return false;
+        }
+        void* mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED) {
+            return false;
+        }
+        
+        const char* base = static_cast<const char*>(mapping);
+        size_t file_size = static_cast<size_t>(st.st_size);
+        uint64_t count;
+        std::memcpy(&count, base + 8, sizeof(count));
+        
+        // 항목마다 오프셋 2개(16바이트)가 필요하므로 개수를 먼저 확인 (헤더 크기 계산의 오버플로 방지)
+        bool valid = std::memcmp(base, "VDBSTR01", 8) == 0 && count <= (file_size - 16) / 16;
+        size_t header_size = valid ? 16 + (2 * count + 1) * sizeof(uint64_t) : 0;
+        valid = valid && header_size <= file_size;
+        
+        // 오프셋은 매핑할 때 한 번만 검사 (단조 증가이고 바이트 블록 안이어야 text_at/metadata_at이 범위를 벗어나지 않음)
+        const uint64_t* offsets = reinterpret_cast<const uint64_t*>(base + 16);
+        uint64_t blob_size = valid ? file_size - header_size : 0;
+        for (size_t i = 0; valid && i <= 2 * count; i++) {
+            valid = offsets[i] <= blob_size && (i == 0 || offsets[i - 1] <= offsets[i]);
+        }
+        if (!valid) {
+            munmap(mapping, st.st_size);
+            return false;
+        }
+        
+        lazy_mapping = base;
+        lazy_mapping_size = st.st_size;
+        lazy_offsets = offsets;
+        lazy_blob = base + header_size;
+        lazy_state.reset(new std::atomic<uint8_t>[count]());
+        lazy_count = count;
+        
+        stored_texts.assign(count, std::string());
+        stored_metadata.assign(count, std::string());
+        return true;
+    }
+    
+    // 백그라운드 워밍업: 매핑된 페이지를 미리 읽어 두고 모든 항목을 디코딩
+    void start_warmup() {
+        warmup_thread = std::thread([this]() {
+            madvise(const_cast<char*>(lazy_mapping), lazy_mapping_size, MADV_WILLNEED);
+            volatile char sink = 0;
+            for (size_t offset = 0; offset < lazy_mapping_size && !warmup_stop; offset += 4096) {
+                sink += lazy_mapping[offset];
+            }
+            for (size_t id = 0; id < lazy_count && !warmup_stop; id++) {
+                materialize(id);
+            }
+        });
+    }
+    
+    // 텍스트와 메타데이터를 .strings 형식으로 기록
+    void write_strings_file(const std::string& file_path, size_t count) {
+        std::vector<uint64_t> offsets(2 * count + 1);
+        uint64_t offset = 0;
+        for (size_t i = 0; i < count; i++) {
+            offsets[2 * i] = offset;
+            offset += text_at(i).size();
+            offsets[2 * i + 1] = offset;
+            offset += metadata_at(i).size();
+        }
+        offsets[2 * count] = offset;
+        
+        // 임시 파일에 쓴 뒤 교체 (지연 로드 중인 기존 파일 매핑은 이전 inode를 계속 가리킴)
+        std::string temp_path = file_path + ".tmp";
+        std::ofstream file(temp_path, std::ios::binary);
+        uint64_t count64 = count;
+        file.write("VDBSTR01", 8);
+        file.write(reinterpret_cast<const char*>(&count64), sizeof(count64));
+        file.write(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(uint64_t));
+        for (size_t i = 0; i < count; i++) {
+            file.write(stored_texts[i].data(), stored_texts[i].size());
+            file.write(stored_metadata[i].data(), stored_metadata[i].size());
+        }
+        file.close();
+        if (!file || std::rename(temp_path.c_str(), file_path.c_str()) != 0) {
+            throw std::runtime_error("텍스트 파일 기록 실패: " + file_path);
+        }
+    }
+    
+    // 동결된 세대를 디스크에 기록 (백그라운드 스레드에서 실행)
+    bool write_generation(const std::string& path, hnswlib::HierarchicalNSW<float>* generation, size_t count) {
+        try {
+            // 인덱스 저장 (동결된 세대는 더 이상 변경되지 않음)
+            generation->saveIndex(path + ".index");
+            
+            // 텍스트와 메타데이터는 지연 로드가 가능한 바이너리 파일로 저장 (동결 시점까지의 항목만)
+            write_strings_file(path + ".strings", count);
+            
+            json metadata;
+            metadata["dimension"] = vector_dimension;
+            metadata["max_elements"] = max_elements;
+            metadata["count"] = count;
+            
+            std::ofstream file(path + ".json");
+            file << metadata.dump(4);
+            file.close();
+            
+            std::cout << "데이터베이스가 " << path << "에 저장되었습니다. (항목 수: " << count << ")" << std::endl;
+            return true;
+        } catch (const std::exception& e) {
+            std::cerr << "저장 중 오류 발생: " << e.what() << std::endl;
+            return false;
+        }
+    }
+    
+    // 동결된 세대의 그래프 재배치
+    // 동결된 세대는 더 이상 변경되지 않으므로 재배치된 메모리는 검색을 받으면서 준비하고,
+    // 교체하는 순간에만 배타적 잠금을 잡습니다.
+    void reorder_frozen_generation(hnswlib::HierarchicalNSW<float>* generation) {
+        if (generation->cur_element_count < 2) {
+            return;
+        }
+        GraphReorder::Layout layout;
+        GraphReorder::build(*generation, GraphReorder::compute_order(*generation), layout);
+        
+        std::unique_lock<std::shared_mutex> lock(generation_mutex);
+        GraphReorder::apply(*generation, layout);
+    }
+    
+    // 저장 후 새 세대의 항목을 동결했던 인덱스로 합치고 단일 세대로 복귀
+    void merge_delta_generation() {
+        hnswlib::HierarchicalNSW<float>* target;
+        {
+            std::unique_lock<std::shared_mutex> lock(generation_mutex);
+            draining_index = index;
+            index = frozen_index;
+            frozen_index = nullptr;
+            target = index;
+        }
+        
+        // 새 삽입은 이미 target으로 들어가므로 draining_index는 읽기 전용
+        for (hnswlib::tableint i = 0; i < draining_index->cur_element_count; i++) {
+            target->addPoint(draining_index->getDataByInternalId(i), draining_index->getExternalLabel(i));
+        }
+        
+        std::unique_lock<std::shared_mutex> lock(generation_mutex);
+        delete draining_index;
+        draining_index = nullptr;
+    }
 
 public:
     enum SimilarityType {
@@ -73,6 +721,13 @@ public:
         EUCLIDEAN,
         MANHATTAN
     };
+    
+    // 이진 양자화 검색 방식
+    enum BinarySearchMode {
+        BINARY_OFF,   // 사용 안 함
+        BINARY_FLAT,  // 모든 이진 코드를 해밍 거리로 전수 스캔
+        BINARY_GRAPH  // 이진 코드 위의 HNSW 그래프로 후보 탐색
+    };
 
     VectorDB(int dim = 384, int max_elems = 10000, const std::string& space = "cosine") 
         : vector_dimension(dim), max_elements(max_elems), embedding_dim(dim) {
@@ -80,12 +735,21 @@ public:
         // HNSW 인덱스 초기화
         std::string space_type = space;
         if (space_type == "cosine") {
-            index = new hnswlib::HierarchicalNSW<float>(hnswlib::InnerProductSpace(dim), max_elements);
+            index_space.reset(new hnswlib::InnerProductSpace(dim));
+            primary_metric = COSINE;
         } else if (space_type == "l2") {
-            index = new hnswlib::HierarchicalNSW<float>(hnswlib::L2Space(dim), max_elements);
+            index_space.reset(new hnswlib::L2Space(dim));
+            primary_metric = EUCLIDEAN;
         } else {
             throw std::runtime_error("지원되지 않는 거리 측정 방식입니다. 'cosine' 또는 'l2'를 사용하세요.");
         }
+        index = new hnswlib::HierarchicalNSW<float>(index_space.get(), max_elements);
+        
+        // 저장 중 동시 삽입이 기존 원소를 재배치하지 않도록 용량 확보
+        stored_texts.reserve(max_elements);
+        stored_metadata.reserve(max_elements);
+        
+        metrics.add_gauge("entries", [this]() { return static_cast<double>(size()); });
         
         // 토크나이저 초기화 (실제로는 모델 파일 경로 지정 필요)
         tokenizer = new sentencepiece::SentencePieceProcessor();
@@ -95,6 +759,15 @@ public:
     }
     
     ~VectorDB() {
+        for (auto& hook : shutdown_hooks) {
+            hook();
+        }
+        
+        // 진행 중인 백그라운드 저장 완료 대기
+        if (pending_save.valid()) {
+            pending_save.wait();
+        }
+        release_lazy_mapping();
         delete index;
         delete tokenizer;
     }
@@ -110,14 +783,108 @@ public:
         // 텍스트 임베딩
         std::vector<float> embedding = embed_text(text);
         
-        // 인덱스에 추가
-        index->addPoint(embedding.data(), current_id);
-        
-        // 원본 텍스트와 메타데이터 저장
-        stored_texts.push_back(text);
-        stored_metadata.push_back(metadata);
-        
-        std::cout << "ID " << current_id << "로 텍스트가 추가되었습니다." << std::endl;
+        // 인덱스에 추가하고 원본 텍스트와 메타데이터 저장
+        append_entry(text, metadata, embedding);
+    }
+    
+    // 미리 계산된 임베딩으로 추가 (분산 DB가 샤드를 고르려고 임베딩을 먼저 계산한 경우), 할당된 ID 반환
+    size_t add_with_embedding(const std::string& text, const std::string& metadata,
+                              const std::vector<float>& embedding) {
+        return append_entry(text, metadata, embedding);
+    }
+    
+    // 저장된 항목 수
+    size_t size() {
+        std::lock_guard<std::mutex> lock(append_mutex);
+        return stored_texts.size();
+    }
+    
+    // 모든 항목의 (텍스트, 메타데이터, 벡터)를 순회 (샤드 분할, 세그먼트 병합 등 재배치용, 순회 중 세대 교체는 대기)
+    // 삭제 표시된 항목은 제외
+    template<typename Visitor>
+    void for_each_entry(Visitor visit) {
+        std::shared_lock<std::shared_mutex> lock(generation_mutex);
+        std::vector<bool> seen(max_elements, false); // 병합 중에는 같은 항목이 두 세대에 있을 수 있음
+        for (auto generation : {index, frozen_index, draining_index}) {
+            if (generation == nullptr) continue;
+            for (hnswlib::tableint i = 0; i < generation->cur_element_count; i++) {
+                size_t id = generation->getExternalLabel(i);
+                if (generation->isMarkedDeleted(i) || id >= seen.size() || seen[id]) continue;
+                seen[id] = true;
+                visit(text_at(id), metadata_at(id), reinterpret_cast<const float*>(generation->getDataByInternalId(i)));
+            }
+        }
+    }
+    
+    // 토크나이저 모델 로드
+    bool load_tokenizer(const std::string& model_path) {
+        auto status = tokenizer->Load(model_path);
+        if (!status.ok()) {
+            std::cerr << "토크나이저 로드 실패: " << status.ToString() << std::endl;
+            return false;
+        }
+        tokenizer_tag = PersistentEmbeddingCache::file_tag(model_path);
+        token_cache.clear();
+        return true;
+    }
+    
+    // 문장 임베딩 모델 로드 (export_minilm.py로 변환한 가중치 파일)
+    // 모델이 바뀌면 기존 벡터와 비교할 수 없으므로 데이터를 추가하기 전에 로드해야 합니다.
+    // 토크나이저는 모델과 같은 SentencePiece 모델을 load_tokenizer로 로드해야 합니다.
+    bool load_embedding_model(const std::string& model_path) {
+        try {
+            std::unique_ptr<MiniLMEmbedder> model(new MiniLMEmbedder(model_path));
+            if (model->dimension() != embedding_dim) {
+                std::cerr << "임베딩 모델 차원(" << model->dimension() << ")이 데이터베이스 차원("
+                          << embedding_dim << ")과 다릅니다." << std::endl;
+                return false;
+            }
+            embedding_model = std::move(model);
+            model_tag = PersistentEmbeddingCache::file_tag(model_path);
+        } catch (const std::exception& e) {
+            std::cerr << "임베딩 모델 로드 실패: " << e.what() << std::endl;
+            return false;
+        }
+        std::cout << "임베딩 모델이 로드되었습니다: " << model_path << std::endl;
+        return true;
+    }
+    
+    // 디스크 임베딩 캐시 열기 (없으면 capacity개 항목 크기로 생성, 이미 있으면 기존 크기 사용)
+    // 같은 파일을 연 모든 프로세스가 서로의 임베딩을 재사용하며, 재시작 후에도 유지됩니다.
+    bool open_embedding_cache(const std::string& path, size_t capacity = 1 << 20) {
+        try {
+            persistent_cache.reset(new PersistentEmbeddingCache(path, embedding_dim, capacity));
+        } catch (const std::exception& e) {
+            std::cerr << "임베딩 캐시 열기 실패: " << e.what() << std::endl;
+            return false;
+        }
+        std::cout << "임베딩 캐시가 열렸습니다: " << path << " (최대 " << persistent_cache->capacity() << "개)" << std::endl;
+        return true;
+    }
+    
+    // 텍스트를 토큰 ID로 변환 (토큰화 성능 측정용)
+    void tokenize(const std::string& text, std::vector<int>& ids) {
+        encode_ids(text, ids);
+    }
+    
+    // 쿼리 임베딩 계산 (여러 샤드에 같은 쿼리를 보낼 때 한 번만 계산하기 위해 사용)
+    std::vector<float> embed_query(const std::string& query) {
+        return embed_text(query);
+    }
+    
+    // 연산별 지연 시간(건수, 평균, p50/p90/p99/p99.9, 최댓값)과 카운터 스냅샷
+    MetricsRegistry::Snapshot metrics_snapshot() {
+        return metrics.snapshot();
+    }
+    
+    // Prometheus 텍스트 형식 (labels 예: shard="0")
+    std::string metrics_prometheus(const std::string& labels = "") {
+        return MetricsRegistry::prometheus_text("vectordb_", {{metrics.snapshot(), labels}});
+    }
+    
+    // 현재 인덱스 버전
+    uint64_t get_index_version() const {
+        return index_version.load();
     }
     
     // 사용자 쿼리에 가장 유사한 텍스트 검색
@@ -126,98 +893,142 @@ public:
         // 쿼리 임베딩
         std::vector<float> query_embedding = embed_text(query);
         
-        // HNSW 라이브러리로 검색 (기본 코사인 유사도)
-        std::priority_queue<std::pair<float, size_t>> results;
-        
-        if (sim_type == COSINE || sim_type == DOT_PRODUCT) {
-            // HNSW 내장 검색 사용 (코사인이나 닷 프로덕트)
-            std::vector<float> distances;
-            std::vector<hnswlib::labeltype> labels;
-            index->searchKnn(query_embedding.data(), k, &labels, &distances);
-            
-            // 결과 변환
-            for (size_t i = 0; i < labels.size(); i++) {
-                float score = 0;
-                if (sim_type == COSINE) {
-                    // 코사인 유사도 = 1 - 거리
-                    score = 1.0f - distances[i];
-                } else {
-                    // 닷 프로덕트
-                    score = -distances[i]; // HNSW에서는 거리가 음수로 저장됨
-                }
-                results.push(std::make_pair(score, labels[i]));
-            }
-        } else {
-            // 유클리드 또는 맨해튼 거리는 모든 벡터와 직접 계산
-            for (size_t i = 0; i < stored_texts.size(); i++) {
-                std::vector<float> stored_embedding = embed_text(stored_texts[i]);
-                float distance = 0.0f;
-                
-                if (sim_type == EUCLIDEAN) {
-                    // 유클리드 거리 계산
-                    for (size_t j = 0; j < vector_dimension; j++) {
-                        float diff = query_embedding[j] - stored_embedding[j];
-                        distance += diff * diff;
-                    }
-                    distance = std::sqrt(distance);
-                    results.push(std::make_pair(-distance, i)); // 거리가 작을수록 유사도가 높음
-                } else if (sim_type == MANHATTAN) {
-                    // 맨해튼 거리 계산
-                    for (size_t j = 0; j < vector_dimension; j++) {
-                        distance += std::abs(query_embedding[j] - stored_embedding[j]);
-                    }
-                    results.push(std::make_pair(-distance, i)); // 거리가 작을수록 유사도가 높음
-                }
-            }
+        return search_by_embedding(query_embedding, k, sim_type);
+    }
+    
+    // 미리 계산된 쿼리 임베딩으로 검색 (검색 결과 캐시가 켜져 있으면 먼저 조회)
+    std::vector<std::pair<std::string, float>> search_by_embedding(const std::vector<float>& query_embedding,
+                                                                  int k = 5,
+                                                                  SimilarityType sim_type = COSINE) {
+        MetricsRegistry::Timer timer(metrics, METRIC_SEARCH);
+        if (!query_cache) {
+            return materialize_results(search_ids(query_embedding, k, sim_type));
         }
         
-        // 결과 변환
-        std::vector<std::pair<std::string, float>> final_results;
-        while (!results.empty() && final_results.size() < k) {
-            auto top = results.top();
-            results.pop();
-            
-            final_results.push_back(std::make_pair(
-                stored_texts[top.second] + 
-                (stored_metadata[top.second].empty() ? "" : " [" + stored_metadata[top.second] + "]"), 
-                top.first
-            ));
+        // 검색 전에 버전을 읽어야 검색 도중 추가된 항목이 있을 때 오래된 결과가 캐시에 남지 않음
+        uint64_t version = index_version.load();
+        QueryResultCache::Results results;
+        if (query_cache->lookup(query_embedding, k, sim_type, "", version, results)) {
+            metrics.add(COUNTER_QUERY_CACHE_HITS);
+            return results;
         }
+        metrics.add(COUNTER_QUERY_CACHE_MISSES);
         
-        // 점수 기준으로 내림차순 정렬 (가장 유사한 것이 먼저 오도록)
-        std::sort(final_results.begin(), final_results.end(), 
-            [](const auto& a, const auto& b) { return a.second > b.second; });
-            
-        return final_results;
+        results = materialize_results(search_ids(query_embedding, k, sim_type));
+        query_cache->insert(query_embedding, k, sim_type, "", version, results);
+        return results;
     }
     
-    // 데이터베이스 저장
+    // 검색 결과 캐시 활성화
+    void enable_query_cache(size_t capacity = 1024, float similarity_threshold = 0.98f, int num_bits = 16) {
+        query_cache.reset(new QueryResultCache(vector_dimension, num_bits, similarity_threshold, capacity));
+        std::cout << "검색 결과 캐시가 활성화되었습니다. 용량: " << capacity
+                  << ", 유사도 임계값: " << similarity_threshold << std::endl;
+    }
+
+    void disable_query_cache() {
+        query_cache.reset();
+    }
+    
+    // 지표 그래프를 미리 생성 (생성하지 않으면 해당 지표로 처음 검색할 때 생성)
+    void enable_metric_index(SimilarityType sim_type) {
+        if (served_by_primary(sim_type)) {
+            return;
+        }
+        build_metric_index(sim_type);
+        std::cout << "지표 그래프가 생성되었습니다. 지표: " << sim_type
+                  << ", 항목 수: " << stored_texts.size() << std::endl;
+    }
+    
+    // 이진 양자화 검색 활성화 (코사인/닷 프로덕트 검색에 적용)
+    // int8_rescore가 true면 후보를 int8 코드로, false면 float 벡터로 다시 채점합니다.
+    // 재채점 후보 수는 k * rescore_factor이며, 클수록 정확하지만 느려집니다.
+    void enable_binary_index(BinarySearchMode mode = BINARY_FLAT, bool int8_rescore = true,
+                             size_t rescore_factor = 8) {
+        {
+            std::unique_lock<std::shared_mutex> lock(generation_mutex);
+            binary_graph.reset();
+            binary_space.reset();
+            binary_index.reset();
+            binary_mode = mode;
+            binary_int8 = int8_rescore;
+            binary_rescore_factor = std::max<size_t>(1, rescore_factor);
+        }
+        if (mode == BINARY_OFF) {
+            return;
+        }
+        build_binary_index();
+        std::cout << "이진 양자화 검색이 활성화되었습니다. 방식: " << (mode == BINARY_FLAT ? "전수 스캔" : "그래프")
+                  << ", 재채점: " << (int8_rescore ? "int8" : "float")
+                  << ", 이진 인덱스 크기: " << (binary_index->memory_bytes() / 1024.0 / 1024.0) << " MB" << std::endl;
+    }
+    
+    // 그래프 재배치: 연결된 노드가 메모리상 가까이 놓이도록 HNSW 내부 ID를 다시 매김 (외부 ID는 그대로)
+    // 재배치하는 동안 검색과 삽입이 멈추므로 유지보수 시간이나 오프라인 도구(graph_reorder_main.cpp)에서 호출합니다.
+    void reorder_index() {
+        std::lock_guard<std::mutex> save_lock(save_mutex);
+        if (pending_save.valid()) {
+            pending_save.wait();
+        }
+        std::unique_lock<std::shared_mutex> lock(generation_mutex);
+        GraphReorder::reorder(*index);
+    }
+    
+    // 저장할 때마다 그래프를 재배치할지 설정 (저장 파일이 재배치된 순서로 기록되어 로드 후에도 유지됨)
+    void set_reorder_on_save(bool enabled) {
+        reorder_on_save = enabled;
+    }
+    
+    // 데이터베이스 저장 (백그라운드 기록이 끝날 때까지 호출한 스레드만 대기)
     bool save(const std::string& path) {
-        try {
-            // 인덱스 저장
-            index->saveIndex(path + ".index");
-            
-            // 메타데이터 및 텍스트 저장
-            json metadata;
-            metadata["dimension"] = vector_dimension;
-            metadata["max_elements"] = max_elements;
-            metadata["texts"] = stored_texts;
-            metadata["metadata"] = stored_metadata;
-            
-            std::ofstream file(path + ".json");
-            file << metadata.dump(4);
-            file.close();
-            
-            std::cout << "데이터베이스가 " << path << "에 저장되었습니다." << std::endl;
-            return true;
-        } catch (const std::exception& e) {
-            std::cerr << "저장 중 오류 발생: " << e.what() << std::endl;
-            return false;
+        return save_async(path).get();
+    }
+    
+    // 데이터베이스 비동기 저장
+    // 현재 세대를 동결하고 새 세대를 만드는 동안만 잠깐 배타적 잠금을 잡으며,
+    // 실제 파일 기록은 백그라운드에서 진행되므로 검색과 삽입은 멈추지 않습니다.
+    std::shared_future<bool> save_async(const std::string& path) {
+        std::lock_guard<std::mutex> save_lock(save_mutex);
+        
+        // 이전 저장(및 세대 병합)이 끝나야 다음 세대를 동결할 수 있음
+        if (pending_save.valid()) {
+            pending_save.wait();
         }
+        
+        hnswlib::HierarchicalNSW<float>* generation;
+        size_t snapshot_count;
+        {
+            std::unique_lock<std::shared_mutex> lock(generation_mutex);
+            frozen_index = index;
+            index = new hnswlib::HierarchicalNSW<float>(index_space.get(), max_elements);
+            generation = frozen_index;
+            snapshot_count = stored_texts.size();
+        }
+        
+        bool reorder = reorder_on_save;
+        pending_save = std::async(std::launch::async, [this, path, generation, snapshot_count, reorder]() {
+            MetricsRegistry::Timer timer(metrics, METRIC_SAVE);
+            if (reorder) {
+                reorder_frozen_generation(generation);
+            }
+            bool ok = write_generation(path, generation, snapshot_count);
+            merge_delta_generation();
+            return ok;
+        }).share();
+        
+        return pending_save;
     }
     
     // 데이터베이스 로드
-    bool load(const std::string& path) {
+    // 새 형식(.strings)은 파일을 매핑만 하고 바로 검색을 받으며, 텍스트는 처음 접근할 때 디코딩합니다.
+    // warm_up이 true면 백그라운드에서 페이지를 미리 읽고 모든 항목을 디코딩합니다.
+    bool load(const std::string& path, bool warm_up = true) {
+        MetricsRegistry::Timer timer(metrics, METRIC_LOAD);
+        std::lock_guard<std::mutex> save_lock(save_mutex);
+        if (pending_save.valid()) {
+            pending_save.wait();
+        }
+        
         try {
             // 메타데이터 및 텍스트 로드
             std::ifstream file(path + ".json");
@@ -225,15 +1036,34 @@ public:
             file >> metadata;
             file.close();
             
+            std::unique_lock<std::shared_mutex> lock(generation_mutex);
+            
+            release_lazy_mapping();
+            reset_metric_indexes(); // 지표 그래프는 저장하지 않으며 필요할 때 다시 생성
+            
             vector_dimension = metadata["dimension"];
             max_elements = metadata["max_elements"];
-            stored_texts = metadata["texts"].get<std::vector<std::string>>();
-            stored_metadata = metadata["metadata"].get<std::vector<std::string>>();
+            if (metadata.contains("texts")) {
+                // 이전 형식: 모든 텍스트가 JSON 안에 있음
+                stored_texts = metadata["texts"].get<std::vector<std::string>>();
+                stored_metadata = metadata["metadata"].get<std::vector<std::string>>();
+            } else if (!map_strings_file(path + ".strings")) {
+                throw std::runtime_error("텍스트 파일을 열 수 없거나 손상되었습니다: " + path + ".strings");
+            }
+            stored_texts.reserve(max_elements);
+            stored_metadata.reserve(max_elements);
             
             // 인덱스 재생성 및 로드
             delete index;
-            index = new hnswlib::HierarchicalNSW<float>(hnswlib::InnerProductSpace(vector_dimension), max_elements);
+            index_space.reset(new hnswlib::InnerProductSpace(vector_dimension));
+            primary_metric = COSINE;
+            index = new hnswlib::HierarchicalNSW<float>(index_space.get(), max_elements);
             index->loadIndex(path + ".index", max_elements);
+            index_version++;
+            
+            if (warm_up && lazy_count > 0) {
+                start_warmup();
+            }
             
             std::cout << "데이터베이스가 " << path << "에서 로드되었습니다." << std::endl;
             std::cout << "저장된 항목 수: " << stored_texts.size() << std::endl;
@@ -243,4 +1073,82 @@ public:
             return false;
         }
     }
+
+private:
+    // 쿼리 임베딩과 가장 유사한 항목의 (점수, ID) 목록을 점수 내림차순으로 반환
+    // stats를 넘기면 실제 탐색 경로의 방문 수와 거리 계산 수를 기록 (explain 검색용)
+    std::vector<std::pair<float, size_t>> search_ids(const std::vector<float>& query_embedding, int k,
+                                                    SimilarityType sim_type, TraversalStats* stats = nullptr) {
+        if (binary_mode != BINARY_OFF && (sim_type == COSINE || sim_type == DOT_PRODUCT)) {
+            std::vector<std::pair<float, size_t>> ranked;
+            if (search_binary(query_embedding, k, sim_type, ranked, stats)) {
+                return ranked;
+            }
+        }
+        
+        std::priority_queue<std::pair<float, size_t>> results;
+        
+        if (served_by_primary(sim_type)) {
+            // 주 인덱스 검색
+            // 저장이 진행 중이면 동결된 세대나 병합 중인 세대도 함께 검색
+            std::shared_lock<std::shared_mutex> lock(generation_mutex);
+            std::unordered_set<size_t> seen;
+            
+            for (auto generation : {index, frozen_index, draining_index}) {
+                if (generation == nullptr) continue;
+                
+                // 이웃 벡터를 prefetch하는 탐색 (graph_layout.cpp)
+                // 결과 변환 (병합 중에는 같은 항목이 두 세대에 모두 있을 수 있음)
+                for (const auto& item : search_with_prefetch(*generation, query_embedding.data(), k, stats)) {
+                    if (!seen.insert(item.second).second) continue;
+                    results.push(std::make_pair(distance_to_score(sim_type, item.first), item.second));
+                }
+            }
+        } else {
+            // 지표 그래프 검색 (없으면 먼저 생성)
+            std::shared_lock<std::shared_mutex> lock(generation_mutex);
+            if (!metric_index[sim_type]) {
+                lock.unlock();
+                build_metric_index(sim_type);
+                lock.lock();
+            }
+            
+            std::vector<float> distances;
+            std::vector<hnswlib::labeltype> labels;
+            const float* query = query_embedding.data();
+            count_hnswlib_search(*metric_index[sim_type], k, stats, [&]() {
+                metric_index[sim_type]->searchKnn(&query, k, &labels, &distances);
+            });
+            
+            for (size_t i = 0; i < labels.size(); i++) {
+                results.push(std::make_pair(distance_to_score(sim_type, distances[i]), labels[i]));
+            }
+        }
+        
+        // 상위 k개 추출 (우선순위 큐에서 꺼내므로 점수 내림차순)
+        std::vector<std::pair<float, size_t>> ranked;
+        while (!results.empty() && ranked.size() < k) {
+            ranked.push_back(results.top());
+            results.pop();
+        }
+        
+        return ranked;
+    }
+    
+    // 검색된 ID를 원본 텍스트와 메타데이터로 변환
+    std::vector<std::pair<std::string, float>> materialize_results(
+        const std::vector<std::pair<float, size_t>>& ranked) {
+        std::vector<std::pair<std::string, float>> final_results;
+        final_results.reserve(ranked.size());
+        
+        for (const auto& item : ranked) {
+            final_results.push_back(std::make_pair(
+                text_at(item.second) +
+                (metadata_at(item.second).empty() ? "" : " [" + metadata_at(item.second) + "]"),
+                item.first
+            ));
+        }
+        
+        return final_results;
+    }
 };
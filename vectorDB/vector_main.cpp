@@ -25,6 +25,13 @@ int main() {
         std::cout << "텍스트: " << result.first << "\n점수: " << result.second << std::endl;
     }
     
+#ifdef VECTORDB_PROFILE
+    // 검색 프로파일 (explain 모드)
+    auto profile = db.explain_search("벡터 간의 유사도를 측정하는 방법은 무엇이 있나요?", 3);
+    VectorDB::print_profile(profile);
+    db.report_profile();
+#endif
+    
     // 데이터베이스 저장
     db.save("vectordb");
     